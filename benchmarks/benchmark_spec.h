@@ -0,0 +1,37 @@
+// Spec shared by the benchmarks
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <cli.h>
+
+// Spec of 26 short flags (-a to -z), optionCount Int64 options named
+// --option-N, and a list of remaining Int64 arguments
+struct Spec {
+	std::vector<std::string> names;
+	std::unique_ptr<bool[]> flags;
+	std::unique_ptr<int64_t[]> values;
+	std::vector<int64_t> remaining;
+	std::unique_ptr<cli::Parser> parser;
+
+	explicit Spec(size_t optionCount) : flags(new bool[26]()), values(new int64_t[optionCount]()) {
+		names.reserve(26 + optionCount);
+		std::vector<cli::Option> options;
+		for(int i = 0; i < 26; ++i) {
+			names.push_back(std::string("flag-") + (char)('a' + i));
+			options.push_back(cli::OptionFlag((char)('a' + i), names.back().c_str(), "a flag", &flags[i]));
+		}
+		for(size_t i = 0; i < optionCount; ++i) {
+			names.push_back("option-" + std::to_string(i));
+			options.push_back(cli::OptionInt64(0, names.back().c_str(), "an integer", false, &values[i]));
+		}
+		options.push_back(cli::RemainingInt64("values", "integers", false, &remaining));
+		parser.reset(new cli::Parser(std::move(options)));
+	}
+
+	size_t size() const {
+		return names.size() + 1;
+	}
+};
@@ -0,0 +1,187 @@
+// Measures the time to compile a synthetic project whose translation units
+// each declare and parse a few options, for each way of including the parser:
+//
+//	header_only - cli.h with the default implementation, compiled in every unit
+//	header_only_all - the same with every optional part (CLI_ENABLE_ALL)
+//	declaration - cli.h with CLI_DECLARATION, linked with coqui_cli
+//	lean - cli_lean.h and a LeanParser, linked with coqui_cli
+//
+// The units are compiled (not linked) in parallel, and the wall time and the
+// CPU time of the compilers are written as JSON to stdout.
+//
+//	compile_benchmark [--units=500] [--jobs=N] [--flags="-O2"] WORK_DIRECTORY
+
+#include <time.h>
+#include <spawn.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <string>
+#include <thread>
+#include <cli.h>
+
+extern char** environ;
+
+namespace {
+
+uint64_t now() {
+	timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return (uint64_t)time.tv_sec * 1000000000 + time.tv_nsec;
+}
+
+struct Variant {
+	const char* name;
+	const char* prologue;
+	const char* parser;
+};
+
+const Variant variants[] = {
+	{"header_only", "#include <cli.h>\n",
+		"\tcli::Parser parser = {\n"},
+	{"header_only_all", "#define CLI_ENABLE_ALL\n#include <cli.h>\n",
+		"\tcli::Parser parser = {\n"},
+	{"declaration", "#define CLI_DECLARATION\n#include <cli.h>\n",
+		"\tcli::Parser parser = {\n"},
+	{"lean", "#include <cli_lean.h>\n",
+		"\tcli::Option options[] = {\n"},
+};
+
+bool writeUnit(const std::string& path, const Variant& variant, int unit) {
+	FILE* out = fopen(path.c_str(), "w");
+	if(out == nullptr) {
+		return false;
+	}
+	bool lean = strcmp(variant.name, "lean") == 0;
+	fprintf(out, "%s\n", variant.prologue);
+	fprintf(out, "int tool%d(int argc, const char* argv[]) {\n", unit);
+	fprintf(out, "\tint jobs = 1;\n\tconst char* target = nullptr;\n\tint verbosity = 0;\n");
+	fprintf(out, "%s", variant.parser);
+	fprintf(out, "\t\tcli::OptionInt('j', \"jobs\", \"parallel jobs\", false, &jobs),\n");
+	fprintf(out, "\t\tcli::OptionString('t', \"target\", \"target %d\", true, &target),\n", unit);
+	fprintf(out, "\t\tcli::OptionFlagCount('v', \"verbose\", \"verbose logging\", &verbosity)\n\t};\n");
+	if(lean) {
+		fprintf(out, "\tcli::LeanParser parser(options);\n");
+	}
+	fprintf(out, "\treturn parser.parse(argc, argv) ? jobs + verbosity : -1;\n}\n");
+	return fclose(out) == 0;
+}
+
+// Splits flags on spaces
+std::vector<std::string> splitFlags(const char* flags) {
+	std::vector<std::string> list;
+	std::string current;
+	for(const char* c = flags; ; ++c) {
+		if(*c == ' ' || *c == '\0') {
+			if(!current.empty()) {
+				list.push_back(current);
+			}
+			current.clear();
+			if(*c == '\0') {
+				break;
+			}
+		} else {
+			current += *c;
+		}
+	}
+	return list;
+}
+
+// Compiles every unit of a variant with at most jobs compilers at once,
+// adding the CPU time of the compilers to cpuTime
+bool compile(const std::string& directory, int units, int jobs, const std::vector<std::string>& flags, uint64_t& cpuTime) {
+	int next = 0;
+	int running = 0;
+	bool valid = true;
+	while(next < units || running > 0) {
+		while(valid && next < units && running < jobs) {
+			std::string source = directory + "/unit" + std::to_string(next) + ".cpp";
+			std::string object = directory + "/unit" + std::to_string(next) + ".o";
+			std::vector<std::string> args = {CLI_CXX_COMPILER, "-std=c++11", "-I" CLI_INCLUDE_DIR};
+			args.insert(args.end(), flags.begin(), flags.end());
+			args.insert(args.end(), {"-c", source, "-o", object});
+			std::vector<char*> argv;
+			for(std::string& arg : args) {
+				argv.push_back(&arg[0]);
+			}
+			argv.push_back(nullptr);
+			pid_t pid;
+			int error = posix_spawnp(&pid, argv[0], nullptr, nullptr, argv.data(), environ);
+			if(error != 0) {
+				fprintf(stderr, "error: can't run '%s': %s\n", argv[0], strerror(error));
+				valid = false;
+				break;
+			}
+			++next;
+			++running;
+		}
+		if(running == 0) {
+			break;
+		}
+		int status;
+		rusage usage;
+		if(wait4(-1, &status, 0, &usage) < 0) {
+			perror("wait4");
+			return false;
+		}
+		--running;
+		cpuTime += (uint64_t)(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000000 +
+			(uint64_t)(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1000;
+		if(!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+			fprintf(stderr, "error: a unit of '%s' failed to compile\n", directory.c_str());
+			valid = false;
+		}
+	}
+	return valid;
+}
+
+}
+
+int main(int argc, const char* argv[]) {
+	int units = 500;
+	int jobs = (int)std::thread::hardware_concurrency();
+	const char* flags = "-O2";
+	cli::Parser parser = {
+		cli::OptionInt('u', "units", "translation units per variant (default 500)", false, &units),
+		cli::OptionInt('j', "jobs", "parallel compilers (default: number of CPUs)", false, &jobs),
+		cli::OptionString('f', "flags", "compiler flags separated by spaces (default -O2)", false, &flags)
+	};
+	if(!parser.parse(argc, argv) || units < 1 || parser.getRemainingArgs().size() != 1) {
+		fprintf(stderr, "\nUsage: compile_benchmark [--units=N] [--jobs=N] [--flags=FLAGS] WORK_DIRECTORY\n\n");
+		parser.printOptionsUsage();
+		return 1;
+	}
+	if(jobs < 1) {
+		jobs = 1;
+	}
+	std::string work = parser.getRemainingArgs()[0];
+	mkdir(work.c_str(), 0755);
+	std::vector<std::string> flagList = splitFlags(flags);
+
+	printf("{\n\t\"units\": %d,\n\t\"jobs\": %d,\n\t\"flags\": \"%s\",\n\t\"variants\": [", units, jobs, flags);
+	for(size_t v = 0; v < sizeof(variants) / sizeof(variants[0]); ++v) {
+		const Variant& variant = variants[v];
+		std::string directory = work + "/" + variant.name;
+		mkdir(directory.c_str(), 0755);
+		for(int unit = 0; unit < units; ++unit) {
+			if(!writeUnit(directory + "/unit" + std::to_string(unit) + ".cpp", variant, unit)) {
+				fprintf(stderr, "error: can't write the units in '%s'\n", directory.c_str());
+				return 1;
+			}
+		}
+		uint64_t cpuTime = 0;
+		uint64_t start = now();
+		if(!compile(directory, units, jobs, flagList, cpuTime)) {
+			return 1;
+		}
+		uint64_t wall = now() - start;
+		printf("%s\n\t\t{\n\t\t\t\"name\": \"%s\"", v > 0 ? "," : "", variant.name);
+		printf(",\n\t\t\t\"wall_ms\": %.1f", wall / 1e6);
+		printf(",\n\t\t\t\"cpu_ms\": %.1f", cpuTime / 1e6);
+		printf(",\n\t\t\t\"cpu_ms_per_unit\": %.2f\n\t\t}", cpuTime / 1e6 / units);
+		fflush(stdout);
+	}
+	printf("\n\t]\n}\n");
+	return 0;
+}
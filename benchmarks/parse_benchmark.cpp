@@ -0,0 +1,146 @@
+// Measures Parser::parse() on a few typical command line shapes and writes
+// the results as JSON to stdout.  Each scenario is parsed repeatedly (reset()
+// followed by parse()) for at least --min-time milliseconds.  Hardware
+// counters are reported per parse, per argument token and per option of the
+// spec, or as null when they aren't available.
+//
+//	parse_benchmark [--min-time=MS]
+
+#include <time.h>
+#include <string>
+// lines are captured for run_replay_benchmark, large lists converted in parallel
+#define CLI_ENABLE_CAPTURE 1
+#define CLI_ENABLE_THREADS 1
+#include <cli.h>
+#include "benchmark_spec.h"
+#include "perf_counters.h"
+
+namespace {
+
+uint64_t now() {
+	timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return (uint64_t)time.tv_sec * 1000000000 + time.tv_nsec;
+}
+
+struct Scenario {
+	const char* name;
+	size_t optionCount;
+	std::vector<std::string> arguments;
+};
+
+std::vector<Scenario> scenarios() {
+	std::vector<Scenario> list;
+
+	Scenario attached = {"long_attached", 100, {}};
+	for(int i = 0; i < 32; ++i) {
+		attached.arguments.push_back("--option-" + std::to_string(i * 3) + "=" + std::to_string(i));
+	}
+	list.push_back(attached);
+
+	Scenario separate = {"long_separate", 100, {}};
+	for(int i = 0; i < 32; ++i) {
+		separate.arguments.push_back("--option-" + std::to_string(i * 3));
+		separate.arguments.push_back(std::to_string(i));
+	}
+	list.push_back(separate);
+
+	Scenario shortFlags = {"short_flags", 100, {}};
+	for(int i = 0; i < 26; ++i) {
+		shortFlags.arguments.push_back(std::string("-") + (char)('a' + i));
+	}
+	list.push_back(shortFlags);
+
+	Scenario clusters = {"short_clusters", 100, {"-abcdefghijklm", "-nopqrstuvwxyz"}};
+	list.push_back(clusters);
+
+	Scenario positionals = {"positionals", 100, {}};
+	for(int i = 0; i < 1000; ++i) {
+		positionals.arguments.push_back(std::to_string(i * 7919));
+	}
+	list.push_back(positionals);
+
+	Scenario large = {"large_spec", 10000, {}};
+	for(int i = 0; i < 32; ++i) {
+		large.arguments.push_back("--option-" + std::to_string(i * 311) + "=" + std::to_string(i));
+	}
+	list.push_back(large);
+
+	return list;
+}
+
+void printCounter(const char* name, const PerfCounters& counters, int counter, double parses, double tokens, double options) {
+	printf(",\n\t\t\t\"%s\": ", name);
+	if(!counters.available(counter)) {
+		printf("null");
+		return;
+	}
+	double value = (double)counters.value(counter);
+	printf("{\"per_parse\": %.2f, \"per_token\": %.3f, \"per_option\": %.4f}", value / parses, value / parses / tokens, value / parses / options);
+}
+
+}
+
+int main(int argc, const char* argv[]) {
+	int minTime = 200;
+	cli::Parser parser = {
+		cli::OptionInt('t', "min-time", "milliseconds per scenario (default 200)", false, &minTime)
+	};
+	if(!parser.parse(argc, argv) || minTime < 1) {
+		fprintf(stderr, "\nUsage: parse_benchmark [--min-time=MS]\n\n");
+		parser.printOptionsUsage();
+		return 1;
+	}
+
+	PerfCounters counters;
+	printf("{\n\t\"counters_available\": %s,\n\t\"scenarios\": [", counters.anyAvailable() ? "true" : "false");
+	std::vector<Scenario> list = scenarios();
+	for(size_t i = 0; i < list.size(); ++i) {
+		const Scenario& scenario = list[i];
+		Spec spec(scenario.optionCount);
+		std::vector<const char*> args(1, "parse_benchmark");
+		for(const std::string& argument : scenario.arguments) {
+			args.push_back(argument.c_str());
+		}
+
+		// warm up and check that the scenario is valid
+		for(int j = 0; j < 16; ++j) {
+			spec.parser->reset();
+			if(!spec.parser->parse((int)args.size(), args.data())) {
+				fprintf(stderr, "error: scenario '%s' doesn't parse\n", scenario.name);
+				return 1;
+			}
+		}
+
+		uint64_t iterations = 0;
+		uint64_t deadline = now() + (uint64_t)minTime * 1000000;
+		uint64_t start = now();
+		uint64_t end;
+		counters.start();
+		do {
+			for(int j = 0; j < 64; ++j) {
+				spec.parser->reset();
+				spec.parser->parse((int)args.size(), args.data());
+			}
+			iterations += 64;
+			end = now();
+		} while(end < deadline);
+		counters.stop();
+
+		double parses = (double)iterations;
+		double tokens = (double)scenario.arguments.size();
+		double options = (double)spec.size();
+		printf("%s\n\t\t{\n\t\t\t\"name\": \"%s\"", i > 0 ? "," : "", scenario.name);
+		printf(",\n\t\t\t\"options\": %zu", spec.size());
+		printf(",\n\t\t\t\"tokens\": %zu", scenario.arguments.size());
+		printf(",\n\t\t\t\"iterations\": %llu", (unsigned long long)iterations);
+		printf(",\n\t\t\t\"ns_per_parse\": %.1f", (end - start) / parses);
+		printf(",\n\t\t\t\"ns_per_token\": %.2f", (end - start) / parses / tokens);
+		for(int counter = 0; counter < PerfCounters::Count; ++counter) {
+			printCounter(PerfCounters::name(counter), counters, counter, parses, tokens, options);
+		}
+		printf("\n\t\t}");
+	}
+	printf("\n\t]\n}\n");
+	return 0;
+}
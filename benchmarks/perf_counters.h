@@ -0,0 +1,125 @@
+// Hardware performance counters of the calling thread, read with
+// perf_event_open() on Linux.  Counters that can't be opened (no PMU in a
+// virtual machine, perf_event_paranoid, other systems) are reported as
+// unavailable instead of failing the benchmark.  With inherit set, the
+// counters also count the children spawned while they're running.
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+class PerfCounters {
+public:
+	enum Counter {
+		Cycles,
+		Instructions,
+		BranchMisses,
+		L1DataMisses,
+		LastLevelMisses,
+		Count
+	};
+
+	static const char* name(int counter) {
+		static const char* names[Count] = {"cycles", "instructions", "branch_misses", "l1d_misses", "llc_misses"};
+		return names[counter];
+	}
+
+	explicit PerfCounters(bool inherit = false) {
+		for(int i = 0; i < Count; ++i) {
+			fds[i] = -1;
+			values[i] = 0;
+		}
+#if defined(__linux__)
+		fds[Cycles] = open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, inherit);
+		fds[Instructions] = open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, inherit);
+		fds[BranchMisses] = open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, inherit);
+		fds[L1DataMisses] = open(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16), inherit);
+		fds[LastLevelMisses] = open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, inherit);
+#endif
+	}
+	PerfCounters(const PerfCounters&) = delete;
+	PerfCounters& operator=(const PerfCounters&) = delete;
+	~PerfCounters() {
+#if defined(__linux__)
+		for(int fd : fds) {
+			if(fd >= 0) {
+				close(fd);
+			}
+		}
+#endif
+	}
+
+	bool available(int counter) const {
+		return fds[counter] >= 0;
+	}
+	bool anyAvailable() const {
+		for(int fd : fds) {
+			if(fd >= 0) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void start() {
+#if defined(__linux__)
+		for(int fd : fds) {
+			if(fd >= 0) {
+				ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+				ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+			}
+		}
+#endif
+	}
+
+	// Stops counting and reads the counts since start(), scaled when the
+	// counters were multiplexed
+	void stop() {
+#if defined(__linux__)
+		for(int fd : fds) {
+			if(fd >= 0) {
+				ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+			}
+		}
+		for(int i = 0; i < Count; ++i) {
+			uint64_t data[3];
+			values[i] = 0;
+			if(fds[i] >= 0 && read(fds[i], data, sizeof(data)) == sizeof(data) && data[2] > 0) {
+				values[i] = data[2] < data[1] ? (uint64_t)((double)data[0] * data[1] / data[2]) : data[0];
+			}
+		}
+#endif
+	}
+
+	uint64_t value(int counter) const {
+		return values[counter];
+	}
+
+private:
+	int fds[Count];
+	uint64_t values[Count];
+
+#if defined(__linux__)
+	static int open(uint32_t type, uint64_t config, bool inherit) {
+		perf_event_attr attr;
+		memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = type;
+		attr.config = config;
+		attr.disabled = 1;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		attr.inherit = inherit ? 1 : 0;
+		attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+		return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+	}
+#endif
+};
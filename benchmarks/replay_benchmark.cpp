@@ -0,0 +1,137 @@
+// Replays a capture log (see CLI_CAPTURE_FILE in cli.h) against the benchmark
+// spec and writes the results as JSON to stdout.  The log is mapped and its
+// lines are parsed in place (reset() followed by parseEncoded()) for at
+// least --min-time milliseconds.  Lines captured with another spec are
+// skipped.  Error messages of invalid lines aren't printed, which leaves
+// their formatting out of the measurement.
+//
+//	CLI_CAPTURE_FILE=capture.log parse_benchmark --min-time=1
+//	replay_benchmark [--options=100] [--min-time=MS] capture.log
+//
+// To replay the traffic of your own tool, replace Spec with its Parser.
+
+// unevaluated, so the arguments still count as used
+#define CLI_LOG_ERROR(fmt, ...) ((void)sizeof(printf(fmt, ##__VA_ARGS__)))
+
+#include <time.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define CLI_ENABLE_CAPTURE 1
+#define CLI_ENABLE_THREADS 1
+#include <cli.h>
+#include "benchmark_spec.h"
+#include "perf_counters.h"
+
+namespace {
+
+uint64_t now() {
+	timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return (uint64_t)time.tv_sec * 1000000000 + time.tv_nsec;
+}
+
+}
+
+int main(int argc, const char* argv[]) {
+	int optionCount = 100;
+	int minTime = 200;
+	cli::Parser parser = {
+		cli::OptionInt('o', "options", "Int64 options of the spec (default 100)", false, &optionCount),
+		cli::OptionInt('t', "min-time", "milliseconds of replay (default 200)", false, &minTime)
+	};
+	if(!parser.parse(argc, argv) || optionCount < 0 || minTime < 1 || parser.getRemainingArgs().size() != 1) {
+		fprintf(stderr, "\nUsage: replay_benchmark [--options=N] [--min-time=MS] LOG\n\n");
+		parser.printOptionsUsage();
+		return 1;
+	}
+	// the replay itself isn't captured
+	cli::setCaptureFile(nullptr);
+
+	const char* path = parser.getRemainingArgs()[0];
+	int fd = open(path, O_RDONLY | O_CLOEXEC);
+	struct stat info;
+	if(fd < 0 || fstat(fd, &info) != 0 || info.st_size == 0) {
+		fprintf(stderr, "error: can't read '%s'\n", path);
+		return 1;
+	}
+	void* mapping = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if(mapping == MAP_FAILED) {
+		fprintf(stderr, "error: can't map '%s'\n", path);
+		return 1;
+	}
+
+	Spec spec((size_t)optionCount);
+	uint64_t fingerprint = spec.parser->fingerprint();
+	std::vector<cli::CapturedLine> lines;
+	size_t skipped = 0;
+	size_t tokens = 0;
+	std::vector<cli::StringView> args;
+	const unsigned char* cursor = (const unsigned char*)mapping;
+	const unsigned char* end = cursor + info.st_size;
+	cli::CapturedLine line;
+	while(cursor < end && cli::readCapturedLine(cursor, end, line)) {
+		if(line.fingerprint != fingerprint || !cli::decodeArguments(line.arguments, line.length, args)) {
+			++skipped;
+			continue;
+		}
+		lines.push_back(line);
+		tokens += args.size() > 0 ? args.size() - 1 : 0;
+	}
+	if(cursor != end) {
+		fprintf(stderr, "warning: '%s' ends with a truncated record\n", path);
+	}
+	if(lines.empty()) {
+		fprintf(stderr, "error: no line of '%s' was captured with this spec\n", path);
+		return 1;
+	}
+
+	size_t invalid = 0;
+	for(const cli::CapturedLine& replayed : lines) {
+		spec.parser->reset();
+		if(!spec.parser->parseEncoded(replayed.arguments, replayed.length)) {
+			++invalid;
+		}
+	}
+
+	PerfCounters counters;
+	uint64_t passes = 0;
+	uint64_t deadline = now() + (uint64_t)minTime * 1000000;
+	uint64_t start = now();
+	uint64_t stop;
+	counters.start();
+	do {
+		for(const cli::CapturedLine& replayed : lines) {
+			spec.parser->reset();
+			spec.parser->parseEncoded(replayed.arguments, replayed.length);
+		}
+		++passes;
+		stop = now();
+	} while(stop < deadline);
+	counters.stop();
+
+	double parses = (double)passes * lines.size();
+	double tokenCount = (double)passes * (tokens > 0 ? tokens : 1);
+	printf("{\n\t\"lines\": %zu", lines.size());
+	printf(",\n\t\"skipped_lines\": %zu", skipped);
+	printf(",\n\t\"invalid_lines\": %zu", invalid);
+	printf(",\n\t\"tokens\": %zu", tokens);
+	printf(",\n\t\"passes\": %llu", (unsigned long long)passes);
+	printf(",\n\t\"ns_per_line\": %.1f", (stop - start) / parses);
+	printf(",\n\t\"ns_per_token\": %.2f", (stop - start) / tokenCount);
+	printf(",\n\t\"counters_available\": %s", counters.anyAvailable() ? "true" : "false");
+	for(int counter = 0; counter < PerfCounters::Count; ++counter) {
+		printf(",\n\t\"%s\": ", PerfCounters::name(counter));
+		if(!counters.available(counter)) {
+			printf("null");
+			continue;
+		}
+		double value = (double)counters.value(counter);
+		printf("{\"per_line\": %.2f, \"per_token\": %.3f}", value / parses, value / tokenCount);
+	}
+	printf("\n}\n");
+	munmap(mapping, (size_t)info.st_size);
+	return 0;
+}
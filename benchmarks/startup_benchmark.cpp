@@ -0,0 +1,193 @@
+// Measures the startup cost of tools built by startup_generate: each binary
+// is spawned repeatedly and the medians are written as JSON to stdout.
+//
+//	startup_benchmark [--runs=N] BINARY...
+//
+// For each binary:
+//	binary_size - size of the executable file in bytes
+//	options - number of options of its Parser
+//	wall_ns - from posix_spawn() to parse() returning in the child
+//	exec_ns - from posix_spawn() to the start of dynamic initialization
+//	dynamic_init_ns - from the start of dynamic initialization to main()
+//	parse_ns - time spent in parse()
+//	minor_faults - minor page faults of the child, over its whole life
+//	max_rss_kb - peak resident memory of the child
+//	cycles, instructions, branch_misses, l1d_misses, llc_misses - hardware
+//	counters of the child (and of the benchmark while it waits) per run and
+//	per option, null when they aren't available
+
+#include <time.h>
+#include <spawn.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cli.h>
+#include "perf_counters.h"
+
+extern char** environ;
+
+namespace {
+
+struct Sample {
+	int options;
+	uint64_t wall;
+	uint64_t exec;
+	uint64_t dynamicInit;
+	uint64_t parse;
+	uint64_t minorFaults;
+	uint64_t maxRss;
+	uint64_t counters[PerfCounters::Count];
+};
+
+uint64_t now() {
+	timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return (uint64_t)time.tv_sec * 1000000000 + time.tv_nsec;
+}
+
+// Spawns the binary once and reads the timestamps it reports
+bool run(const char* binary, PerfCounters& counters, Sample& sample) {
+	int fds[2];
+	if(pipe(fds) != 0) {
+		perror("pipe");
+		return false;
+	}
+	posix_spawn_file_actions_t actions;
+	posix_spawn_file_actions_init(&actions);
+	posix_spawn_file_actions_adddup2(&actions, fds[1], STDOUT_FILENO);
+	posix_spawn_file_actions_addclose(&actions, fds[0]);
+	posix_spawn_file_actions_addclose(&actions, fds[1]);
+	char* argv[] = {(char*)binary, (char*)"--option-0=1", nullptr};
+
+	pid_t pid;
+	counters.start();
+	uint64_t spawned = now();
+	int error = posix_spawn(&pid, binary, &actions, nullptr, argv, environ);
+	posix_spawn_file_actions_destroy(&actions);
+	close(fds[1]);
+	if(error != 0) {
+		fprintf(stderr, "error: can't spawn '%s': %s\n", binary, strerror(error));
+		close(fds[0]);
+		counters.stop();
+		return false;
+	}
+
+	char output[256];
+	size_t length = 0;
+	ssize_t count;
+	while(length + 1 < sizeof(output) && (count = read(fds[0], output + length, sizeof(output) - 1 - length)) > 0) {
+		length += count;
+	}
+	output[length] = '\0';
+	close(fds[0]);
+
+	int status;
+	rusage usage;
+	pid_t waited = wait4(pid, &status, 0, &usage);
+	counters.stop();
+	for(int i = 0; i < PerfCounters::Count; ++i) {
+		sample.counters[i] = counters.value(i);
+	}
+	if(waited != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+		fprintf(stderr, "error: '%s' failed\n", binary);
+		return false;
+	}
+	unsigned long long initStart, mainEntry, parsed;
+	if(sscanf(output, "%d %llu %llu %llu", &sample.options, &initStart, &mainEntry, &parsed) != 4) {
+		fprintf(stderr, "error: unexpected output from '%s'\n", binary);
+		return false;
+	}
+	sample.wall = parsed - spawned;
+	sample.exec = initStart - spawned;
+	sample.dynamicInit = mainEntry - initStart;
+	sample.parse = parsed - mainEntry;
+	sample.minorFaults = usage.ru_minflt;
+	sample.maxRss = usage.ru_maxrss;
+	return true;
+}
+
+template<typename Field>
+uint64_t median(std::vector<Sample>& samples, Field field) {
+	std::sort(samples.begin(), samples.end(), [&](const Sample& a, const Sample& b) {
+		return a.*field < b.*field;
+	});
+	return samples[samples.size() / 2].*field;
+}
+
+uint64_t medianCounter(std::vector<Sample>& samples, int counter) {
+	std::sort(samples.begin(), samples.end(), [&](const Sample& a, const Sample& b) {
+		return a.counters[counter] < b.counters[counter];
+	});
+	return samples[samples.size() / 2].counters[counter];
+}
+
+void printString(const char* value) {
+	putchar('"');
+	for(; *value != '\0'; ++value) {
+		if(*value == '"' || *value == '\\') {
+			putchar('\\');
+		}
+		putchar(*value);
+	}
+	putchar('"');
+}
+
+}
+
+int main(int argc, const char* argv[]) {
+	int runs = 50;
+	cli::Parser parser = {
+		cli::OptionInt('r', "runs", "spawns per binary (default 50)", false, &runs)
+	};
+	if(!parser.parse(argc, argv) || runs < 1 || parser.getRemainingArgs().empty()) {
+		fprintf(stderr, "\nUsage: startup_benchmark [--runs=N] BINARY...\n\n");
+		parser.printOptionsUsage();
+		return 1;
+	}
+
+	// inherited, so that they count the spawned children
+	PerfCounters counters(true);
+	printf("{\n\t\"runs\": %d,\n\t\"counters_available\": %s,\n\t\"binaries\": [", runs, counters.anyAvailable() ? "true" : "false");
+	const std::vector<const char*>& binaries = parser.getRemainingArgs();
+	for(size_t i = 0; i < binaries.size(); ++i) {
+		const char* binary = binaries[i];
+		struct stat info;
+		if(stat(binary, &info) != 0) {
+			fprintf(stderr, "error: can't stat '%s'\n", binary);
+			return 1;
+		}
+		// the first run warms the page cache
+		std::vector<Sample> samples(runs + 1);
+		for(Sample& sample : samples) {
+			if(!run(binary, counters, sample)) {
+				return 1;
+			}
+		}
+		samples.erase(samples.begin());
+
+		printf("%s\n\t\t{\n\t\t\t\"binary\": ", i > 0 ? "," : "");
+		printString(binary);
+		printf(",\n\t\t\t\"binary_size\": %llu", (unsigned long long)info.st_size);
+		printf(",\n\t\t\t\"options\": %d", samples[0].options);
+		printf(",\n\t\t\t\"wall_ns\": %llu", (unsigned long long)median(samples, &Sample::wall));
+		printf(",\n\t\t\t\"exec_ns\": %llu", (unsigned long long)median(samples, &Sample::exec));
+		printf(",\n\t\t\t\"dynamic_init_ns\": %llu", (unsigned long long)median(samples, &Sample::dynamicInit));
+		printf(",\n\t\t\t\"parse_ns\": %llu", (unsigned long long)median(samples, &Sample::parse));
+		printf(",\n\t\t\t\"minor_faults\": %llu", (unsigned long long)median(samples, &Sample::minorFaults));
+		printf(",\n\t\t\t\"max_rss_kb\": %llu", (unsigned long long)median(samples, &Sample::maxRss));
+		for(int counter = 0; counter < PerfCounters::Count; ++counter) {
+			printf(",\n\t\t\t\"%s\": ", PerfCounters::name(counter));
+			if(!counters.available(counter)) {
+				printf("null");
+				continue;
+			}
+			uint64_t value = medianCounter(samples, counter);
+			printf("{\"per_run\": %llu, \"per_option\": %.2f}", (unsigned long long)value, (double)value / samples[0].options);
+		}
+		printf("\n\t\t}");
+	}
+	printf("\n\t]\n}\n");
+	return 0;
+}
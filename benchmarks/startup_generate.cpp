@@ -0,0 +1,60 @@
+// Writes the source of a minimal tool whose Parser has the given number of
+// options, used by startup_benchmark.  The tool reports the monotonic time at
+// which dynamic initialization started, main() was entered and parsing
+// completed.
+//
+//	startup_generate 1000 startup_1000.cpp
+
+#include <stdio.h>
+#include <stdlib.h>
+
+int main(int argc, const char* argv[]) {
+	if(argc != 3) {
+		fprintf(stderr, "usage: startup_generate OPTION_COUNT OUTPUT\n");
+		return 1;
+	}
+	long count = strtol(argv[1], nullptr, 10);
+	if(count < 1) {
+		fprintf(stderr, "error: invalid option count '%s'\n", argv[1]);
+		return 1;
+	}
+	FILE* out = fopen(argv[2], "w");
+	if(out == nullptr) {
+		fprintf(stderr, "error: can't write '%s'\n", argv[2]);
+		return 1;
+	}
+
+	fprintf(out, "// Generated by startup_generate, %ld options\n\n", count);
+	fprintf(out, "#include <time.h>\n#include <cli.h>\n\n");
+	fprintf(out,
+		"static uint64_t now() {\n"
+		"\ttimespec time;\n"
+		"\tclock_gettime(CLOCK_MONOTONIC, &time);\n"
+		"\treturn (uint64_t)time.tv_sec * 1000000000 + time.tv_nsec;\n"
+		"}\n\n"
+		"// runs before the C++ dynamic initializers\n"
+		"static uint64_t initStart;\n"
+		"__attribute__((constructor(101))) static void markInitStart() {\n"
+		"\tinitStart = now();\n"
+		"}\n\n");
+	fprintf(out, "static int64_t values[%ld];\n\n", count);
+	fprintf(out, "static cli::Parser parser = {\n");
+	for(long i = 0; i < count; ++i) {
+		fprintf(out, "\tcli::OptionInt64(0, \"option-%ld\", \"value of option %ld\", false, &values[%ld])%s\n", i, i, i, i + 1 < count ? "," : "");
+	}
+	fprintf(out, "};\n\n");
+	fprintf(out,
+		"int main(int argc, const char* argv[]) {\n"
+		"\tuint64_t mainEntry = now();\n"
+		"\tbool valid = parser.parse(argc, argv);\n"
+		"\tuint64_t parsed = now();\n"
+		"\tprintf(\"%%d %%llu %%llu %%llu\\n\", %ld, (unsigned long long)initStart, (unsigned long long)mainEntry, (unsigned long long)parsed);\n"
+		"\treturn valid ? 0 : 1;\n"
+		"}\n", count);
+
+	if(fclose(out) != 0) {
+		fprintf(stderr, "error: can't write '%s'\n", argv[2]);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,6 @@
+// Implementation of the parser compiled once for the coqui_cli library.
+// Translation units linked with it include cli.h with CLI_DECLARATION defined,
+// or cli_lean.h.  Every optional part is compiled in.
+
+#define CLI_ENABLE_ALL 1
+#include "cli.h"
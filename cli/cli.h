@@ -27,6 +27,12 @@ Author: John Cannon
 	CLI_DECLARATION and CLI_IMPLEMENTATION to include just the declarations
 	or implementations respectively.  By default, both are included.
 
+	The implementation only compiles the core parser unless CLI_ENABLE_THREADS,
+	CLI_ENABLE_PATTERNS, CLI_ENABLE_SWEEPS, CLI_ENABLE_COMPOSITE,
+	CLI_ENABLE_VALIDATION_CACHE, CLI_ENABLE_SHARED_VALUES,
+	CLI_ENABLE_USAGE_COUNTERS, CLI_ENABLE_CAPTURE or CLI_ENABLE_DESCRIPTIONS
+	are defined, or CLI_ENABLE_ALL for all of them.
+
 	Link with -std=c++1
 
 # Example
@@ -75,14 +81,105 @@ Author: John Cannon
 	OptionFlag - A simple boolean flag option
 	OptionFlagCount - A flag option that can occur multiple times is counted (i.e., verbosity)
 	OptionInt - An integer option
+	OptionInt64 - A 64 bit integer option
 	OptionFloat - A floating point option
+	OptionDouble - A double precision floating point option
 	OptionString - A string option
+	OptionStringView - A string option bound to a StringView (pointer and length)
+	OptionDecimal - A fixed-point decimal option stored as a scaled int64_t (e.g., 0.00125 with 5 digits is 125)
+	OptionHex - A binary option given as hex digits, decoded into a Blob
+	OptionBase64 - A binary option given as base64, decoded into a Blob
+	OptionSecretFd - A secret read from the file descriptor given as the value (e.g., --token-fd=3)
+	OptionGlob - A glob pattern (*, ?, [a-z], {a,b}) compiled into a Pattern
+	OptionRegex - A regular expression (subset) compiled into a Pattern
+	OptionFilesFrom - A file listing one path per line, read into a FileList
+	OptionShard - The K/N shard of the FileList it is bound to (e.g., --shard=2/8)
 
 	A couple of experimental option types:
 
 	OptionPath - A file path option (can optionally be validated)
 	OptionPathExisting - A file path option that must point to an existing file (can optionally be validated)
 
+	Any option that takes a parameter can be wrapped in OptionalValue() to make
+	its value optional (e.g., --color, --color=always).  Optional values are
+	only read when attached to the option (--color=always or -calways), the
+	next argument is never consumed.  When used bare, the option is parsed as
+	if the given implicit value had been passed.
+
+		cli::OptionalValue(cli::OptionString('c', "color", "colorize output", false, &color), "auto")
+
+	Positional arguments can be converted into typed slots, which are filled in
+	the order they're declared.  The arguments left after the slots can be
+	converted into a typed array, which is done in parallel for large lists.
+	Arguments that aren't captured by a slot or array are returned by
+	getRemainingArgs().
+
+	PositionalInt64, PositionalDouble, PositionalPath - A single typed positional argument
+	RemainingInt64, RemainingDouble, RemainingPaths - All other positional arguments, as a std::vector
+
+	parseSweep() parses a command line whose values describe a parameter sweep
+	(e.g., --seed={1..1000} --lr=0.1,0.01) into a Sweep.  Each variant of the
+	sweep is selected by index, which converts only the swept values into
+	their variables.
+
+	Wrapper tools can call passThroughUnknownOptions() before parsing to collect
+	unknown options instead of failing.  They're recorded in their original
+	order as ranges of argv indices, and getPassThroughArgv() returns them as a
+	NULL-terminated array for execv() that points into the original argv.
+
+	Programs made of several components, each with their own Parser, can parse
+	a single command line with a CompositeParser.  It merges the option names of
+	the components and routes each argument to the component that owns it.
+
+		cli::CompositeParser parser = { &logging.parser, &storage.parser, &appParser };
+
+	By default an option (other than OptionFlagCount) can only be given once.
+	setRepeatPolicy() changes this for a whole Parser and OnRepeat() for a
+	single option:
+
+		RepeatPolicy::Error - Repeating the option is an error
+		RepeatPolicy::LastWins - The last value is used, earlier ones aren't converted
+		RepeatPolicy::FirstWins - The first value is used, later ones aren't converted
+		RepeatPolicy::Accumulate - Every value is converted and kept, see getValues()
+
+	parse() also accepts arguments that aren't NUL-terminated, as an array of
+	StringView or a range of std::string / std::string_view.  Arguments sent
+	between processes can be packed with encodeArguments() and parsed in
+	place from the received buffer with parseEncoded().  Setting the
+	CLI_CAPTURE_FILE environment variable appends anonymized command lines to
+	a log that benchmarks can replay.
+
+	Tools with very large specs can build them at run time, move them into
+	the Parser and call setLazy(true).  parse() then only records the value
+	given to each option, and converts it on the first get<T>("name") call.
+
+	Files that only declare options can include cli_lean.h, which doesn't
+	need the standard library, and parse with a LeanParser.  The coqui_cli
+	library holds the implementation compiled once.
+
+	Programs written in other languages can use the C interface in cli_c.h,
+	built as the cli_c shared library.
+
+	Setting the CLI_USAGE_DIR environment variable counts how often each
+	option is given, in a segment shared by every process using the spec.
+
+	Options declared with a NULL description can take theirs from a table
+	compressed by the cli_descriptions tool, given with setDescriptions() or
+	setDescriptionFile().  It's only decompressed by printOptionsUsage().
+
+	On Linux, SharedValues::create() copies the parsed values into a sealed
+	memfd that forked or exec'd workers map read-only with open(fd).
+
+	Services validating many similar command lines can use validate() with a
+	ValidationCache.  Lines whose options are byte-for-byte identical to a
+	cached line reuse its outcome and converted values.
+
+	String, Hex and Base64 options can be wrapped in ValueFromFile() to accept
+	@path as a value.  The file is mapped read-only and the option points
+	directly into the mapping, which stays valid as long as the Parser.  String
+	values are NUL-terminated, Blob values are the raw contents of the file.
+	Use @@ for a value that starts with a literal @.
+
 */
 
 #if !defined(CLI_DECLARATION) && !defined(CLI_IMPLEMENTATION)
@@ -92,8 +189,12 @@ Author: John Cannon
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdint.h>
+#include <string.h>
 #include <vector>
+#include <unordered_map>
 #include <initializer_list>
+#include <memory>
 
 #ifndef CLI_LOG_ERROR
 #define CLI_LOG_ERROR(fmt, ...) fprintf(stderr, fmt, ##__VA_ARGS__)
@@ -106,308 +207,4266 @@ Author: John Cannon
 #if defined(CLI_DECLARATION) && !defined(_CLI_DECLARATION_INCLUSION_GUARD)
 #define _CLI_DECLARATION_INCLUSION_GUARD
 
+#include "cli_lean.h"
+
 namespace cli {
 
-struct Option {
-	enum class Type {
-		Flag,
-		FlagCount,
-		Int,
-		Float,
-		String,
-		Path,
-		PathExisting
+// Matcher compiled from a Glob or Regex option.  Patterns are compiled into a
+// DFA once when parsing, so match() is a single table lookup per byte.
+//
+// Globs match the whole text: * matches any sequence (including /), ? any
+// character, [abc], [a-z] and [!abc] a set of characters, {a,b} either
+// alternative and \ escapes the next character.
+//
+// Regular expressions find a match anywhere in the text unless anchored with ^
+// and $.  Anchors apply to the top-level alternative they start or end, as in
+// POSIX and PCRE (^a|b$ matches texts starting with a or ending with b), and
+// aren't supported inside groups.  The supported subset is literals, ., [...]
+// and [^...] sets, \d, \w, \s, grouping with (), alternation with | and the
+// *, + and ? quantifiers.
+class Pattern {
+public:
+	enum class Syntax {
+		Glob,
+		Regex
 	};
-	Type type;
-	char shortName;
-	const char* longName;
-	const char* description;
-	bool isRequired;
-	
-	bool isSet;
-	void* valuePointer;
 
-	bool requiresParameter() const {
-		return type != Option::Type::Flag && type != Option::Type::FlagCount;
+	Pattern() : byteClasses(), classCount(0) {}
+
+	// Returns false and sets error and errorOffset if the pattern is malformed
+	bool compile(const char* pattern, size_t length, Syntax syntax, const char*& error, size_t& errorOffset);
+
+	bool isCompiled() const {
+		return classCount > 0;
 	}
 
-	template<typename T> 
-	T& as() const {
-		return *static_cast<T*>(valuePointer);
+	bool match(const char* text, size_t length) const {
+		if(classCount == 0) return false;
+		// state 0 rejects everything, state 1 is the start state
+		uint32_t state = 1;
+		for(size_t i = 0; i < length; ++i) {
+			state = transitions[state * classCount + byteClasses[(unsigned char)text[i]]];
+			if(state == 0) return false;
+		}
+		return accepting[state] != 0;
+	}
+
+	bool match(const char* text) const {
+		return match(text, strlen(text));
 	}
+
+private:
+	unsigned char byteClasses[256];
+	uint32_t classCount;
+	std::vector<uint16_t> transitions;
+	std::vector<unsigned char> accepting;
 };
 
-Option OptionFlag(char shortName, const char* longName, const char* description, bool* valuePointer);
-Option OptionFlagCount(char shortName, const char* longName, const char* description, int* valuePointer);
-Option OptionInt(char shortName, const char* longName, const char* description, bool required, int* valuePointer);
-Option OptionFloat(char shortName, const char* longName, const char* description, bool required, float* valuePointer);
-Option OptionString(char shortName, const char* longName, const char* description, bool required, const char** valuePointer);
-Option OptionPath(char shortName, const char* longName, const char* description, bool required, const char** valuePointer);
-Option OptionPathExisting(char shortName, const char* longName, const char* description, bool required, const char** valuePointer);
+// Decoders used by the Hex and Base64 options.  out must have room for the
+// decoded length.  On failure errorOffset is set to the offset of the first
+// invalid character, or to length if the input is truncated.
+size_t decodedHexLength(const char* in, size_t length);
+bool decodeHex(const char* in, size_t length, unsigned char* out, size_t& errorOffset);
+size_t decodedBase64Length(const char* in, size_t length);
+bool decodeBase64(const char* in, size_t length, unsigned char* out, size_t& errorOffset);
 
-class Parser {
+// Compact encoding of an argument list for IPC: the argument count followed
+// by the length and bytes of each argument, with counts and lengths as
+// unsigned LEB128 varints.  Arguments aren't NUL-terminated.
+size_t encodedArgumentsLength(int argc, const char* const argv[]);
+// Writes the encoding into out, which must have room for encodedArgumentsLength()
+// bytes, and returns the number of bytes written
+size_t encodeArguments(int argc, const char* const argv[], unsigned char* out);
+// Slices the arguments of an encoding without copying them.  Fails if the
+// encoding is truncated or has trailing bytes.
+bool decodeArguments(const unsigned char* in, size_t length, std::vector<StringView>& args);
+
+// Command lines given to Parser::parse() are appended to the file named by
+// the CLI_CAPTURE_FILE environment variable when it is set (except in setuid
+// and setgid processes), to benchmark the parser on real traffic.  Values are anonymized: digits become 1, letters
+// become a and other bytes are kept, and so are the names of known options.
+// Each record is the length of the rest as a varint, the fingerprint of the
+// spec as 8 little-endian bytes and the arguments encoded as with
+// encodeArguments().  Records are appended with a single write().
+struct CapturedLine {
+	uint64_t fingerprint;
+	const unsigned char* arguments;
+	size_t length;
+};
+// Overrides CLI_CAPTURE_FILE, NULL disables capturing
+void setCaptureFile(const char* path);
+// Reads the record at in and moves past it.  Fails if the record is truncated.
+bool readCapturedLine(const unsigned char*& in, const unsigned char* end, CapturedLine& line);
+
+// Descriptions of large specs can be kept apart from the options in a
+// compressed table (a sidecar file, or an array in a section of its own), so
+// that help text isn't loaded until it's printed.  The table maps long names
+// to descriptions, NUL-terminated, compressed with a small LZ77 scheme.
+void encodeDescriptions(const char* const names[], const char* const descriptions[], size_t count, std::vector<unsigned char>& out);
+// Decompresses a table into pairs of NUL-terminated names and descriptions
+bool decodeDescriptions(const unsigned char* in, size_t length, std::vector<char>& text);
+
+// The other option factories are declared in cli_lean.h
+Option RemainingInt64(const char* name, const char* description, bool required, std::vector<int64_t>* valuePointer);
+Option RemainingDouble(const char* name, const char* description, bool required, std::vector<double>* valuePointer);
+Option RemainingPaths(const char* name, const char* description, bool required, std::vector<const char*>* valuePointer);
+
+// Read-only mapping of a file used for @path values.  The contents are always
+// followed by a NUL byte.
+class MappedFile {
 public:
-	Parser(std::initializer_list<Option> options) : options(options), executableName(nullptr) {}
-	bool parse(int argc, const char* argv[]);
-	bool validatePathOptions();
-	void printOptionsUsage();
+	MappedFile() : data(nullptr), length(0), mappedLength(0) {}
+	MappedFile(MappedFile&& other);
+	MappedFile& operator=(MappedFile&& other);
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	~MappedFile();
 
-	const std::vector<const char*>& getRemainingArgs() const {
-		return remaining;
+	bool open(const char* path);
+
+	const char* data;
+	size_t length;
+
+private:
+	size_t mappedLength;
+	std::vector<char> contents;	// used where mmap isn't available
+	void close();
+};
+
+// Page-aligned memory that is locked in RAM, excluded from core dumps where
+// supported and zeroed before it is released.
+class LockedBuffer {
+public:
+	LockedBuffer() : data(nullptr), size(0) {}
+	LockedBuffer(LockedBuffer&& other);
+	LockedBuffer& operator=(LockedBuffer&& other);
+	LockedBuffer(const LockedBuffer&) = delete;
+	LockedBuffer& operator=(const LockedBuffer&) = delete;
+	~LockedBuffer();
+
+	bool allocate(size_t size);
+
+	char* data;
+	size_t size;
+
+private:
+	void release();
+};
+
+// Lines of a file list given with an OptionFilesFrom option, restricted to one
+// shard when an OptionShard option bound to the same FileList is given as K/N
+// (1 <= K <= N).  The file is mapped, and the offsets of the shard's lines are
+// found in parallel chunks.  Lines of other shards are counted but not stored.
+// Empty lines are skipped and a trailing '\r' is removed.
+class FileList {
+public:
+	enum class Selection {
+		Range,	// shard K holds the K-th contiguous run of lines
+		Hash	// shard K holds the lines whose FNV-1a hash is K-1 modulo N
+	};
+
+	struct Line {
+		const char* data;
+		size_t length;
+	};
+
+	explicit FileList(Selection selection = Selection::Range) : selection(selection), path(nullptr), shardIndex(0), shardCount(1), total(0) {}
+
+	size_t size() const {
+		return lines.size();
+	}
+	const Line& operator[](size_t i) const {
+		return lines[i];
+	}
+	std::vector<Line>::const_iterator begin() const {
+		return lines.begin();
+	}
+	std::vector<Line>::const_iterator end() const {
+		return lines.end();
+	}
+	// number of lines in all the shards
+	size_t totalCount() const {
+		return total;
 	}
 
+	Selection selection;
+
 private:
-	std::vector<Option> options;
-	std::vector<const char*> remaining;
-	const char* executableName;
+	friend class Parser;
 
-	int applyOption(Option& opt, int argc, const char** argv);
-	bool isNumeric(const char* str, bool floatingPoint);
-	int handleOption(int argc, const char** argv);
-	const char* optionTypeDisplayName(Option::Type type);
-	bool checkExistsReadable(const char* path);
+	const char* path;
+	size_t shardIndex;	// 0-based
+	size_t shardCount;
+	size_t total;
+	MappedFile file;
+	std::vector<Line> lines;
 
+	bool load();
+	void clear();
 };
 
-}; // end namespace
+// Range of argv indices, end is exclusive
+struct ArgumentRange {
+	int begin;
+	int end;
+};
 
-#endif // CLI_DECLARATION
+// Classification of a single command line argument
+struct Token {
+	enum class Kind {
+		Positional,
+		Short,		// -abc, name is the list of short options
+		Long		// --name or --name=value
+	};
+	Kind kind;
+	const char* name;
+	size_t nameLength;
+	// Value attached with '=' to a long option, NULL if there is none
+	const char* value;
+	size_t valueLength;
+};
 
-#if defined(CLI_IMPLEMENTATION) && !defined(_CLI_IMPLEMENTATION_INCLUSION_GUARD)
-#define _CLI_IMPLEMENTATION_INCLUSION_GUARD
+class Sweep;
+class CompositeParser;
+class ValidationCache;
+class SharedValues;
 
-namespace cli {
+// Command line of a batch passed to Parser::validateBatch()
+struct CommandLine {
+	int argc;
+	const char** argv;
+};
 
-bool Parser::parse(int argc, const char* argv[]) {
-	executableName = argv[0];
+// Entry of a sorted index of long option names
+struct OptionName {
+	const char* name;
+	size_t length;
+	size_t option;
+};
 
-	for(int i = 1; i < argc; ++i) {
-		int result = handleOption(argc-i,argv+i);
-		// error
-		if(result < 0) return false;
-		// skip any consumed parameters
-		i+= result;
+class Parser;
+
+// Counts of how often each option of a spec is given, shared by every
+// process that parses with the spec.  Counting is enabled by naming a
+// directory in the CLI_USAGE_DIR environment variable (or with
+// setUsageDirectory()), preferably in a memory file system such as /dev/shm.
+// setuid and setgid processes ignore the variable.
+// Each spec gets a segment named after its fingerprint, which a Parser maps
+// on its first parse.  Options are then counted with relaxed atomic
+// increments, without system calls.  Segments are read with open().
+class UsageSegment {
+public:
+	UsageSegment() : header(nullptr), length(0), names(nullptr) {}
+	UsageSegment(UsageSegment&& other);
+	UsageSegment& operator=(UsageSegment&& other);
+	UsageSegment(const UsageSegment&) = delete;
+	UsageSegment& operator=(const UsageSegment&) = delete;
+	~UsageSegment();
+
+	// Maps the segment of the parser's spec in directory, creating it if needed
+	bool attach(const char* directory, const Parser& parser);
+	// Maps a segment read-only
+	bool open(const char* path);
+
+	bool isOpen() const {
+		return header != nullptr;
 	}
-	for(Option& opt : options) {
-		if(opt.isRequired && !opt.isSet) {
-			CLI_LOG_ERROR("error: option -%c/--%s is required\n", opt.shortName, opt.longName);
-			return false;
-		}
+	uint64_t fingerprint() const;
+	// Number of parses counted
+	uint64_t parses() const;
+	size_t optionCount() const;
+	// Long name of an option, or name of a positional option
+	const char* name(size_t option) const;
+	uint64_t count(size_t option) const;
+
+private:
+	struct Header {
+		uint32_t magic;
+		uint32_t version;
+		uint64_t fingerprint;
+		uint64_t optionCount;
+		uint64_t namesLength;
+		uint64_t parses;
+	};
+	// a counter per option follows the header, then the NUL-terminated names
+	Header* header;
+	size_t length;
+	const char* names;
+	std::vector<uint32_t> nameOffsets;
+
+	friend class Parser;
+
+	uint64_t* counters() const {
+		return (uint64_t*)(header + 1);
 	}
-	return true;
-}
+	void increment(uint64_t* counter);
+	bool map(int fd, bool writable);
+	void close();
+};
 
-bool Parser::validatePathOptions() {
-	bool valid = true;
-	for(Option& opt: options) {
-		if(opt.type == Option::Type::PathExisting && !checkExistsReadable(opt.as<const char*>())) {
-			valid = false;
-			CLI_LOG_ERROR("error: option -%c/--%s requires a readable file\n", opt.shortName, opt.longName);
+// Overrides CLI_USAGE_DIR, NULL disables counting for parsers that haven't parsed yet
+void setUsageDirectory(const char* path);
+
+class Parser {
+public:
+	Parser(std::initializer_list<Option> options) : options(options), executableName(nullptr), arguments(nullptr), argumentsTerminated(true), nextPositional(0), sweep(nullptr), passThroughMode(PassThrough::None), passThroughArgv(2, nullptr), repeatPolicy(RepeatPolicy::Error), currentIndex(0), deferPositionals(false), lazy(false), usageChecked(false), descriptionTable(nullptr), descriptionTableLength(0), descriptionFile(nullptr) {
+		buildNameIndex();
+	}
+	// Takes over a spec built at run time without copying it
+	explicit Parser(std::vector<Option>&& options) : options(std::move(options)), executableName(nullptr), arguments(nullptr), argumentsTerminated(true), nextPositional(0), sweep(nullptr), passThroughMode(PassThrough::None), passThroughArgv(2, nullptr), repeatPolicy(RepeatPolicy::Error), currentIndex(0), deferPositionals(false), lazy(false), usageChecked(false), descriptionTable(nullptr), descriptionTableLength(0), descriptionFile(nullptr) {
+		buildNameIndex();
+	}
+	bool parse(int argc, const char* argv[]);
+	// Parses arguments that aren't NUL-terminated, starting with the program
+	// name.  String and path options get NUL-terminated copies owned by the
+	// Parser, StringView options point into the arguments.
+	bool parse(const StringView* args, size_t count);
+	// Parses arguments encoded with encodeArguments() in place, the values of
+	// StringView options point into the buffer
+	bool parseEncoded(const unsigned char* data, size_t length);
+	// Parses a range of objects with data() and size(), such as std::string
+	// or std::string_view, starting with the program name
+	template<typename Iterator>
+	bool parse(Iterator begin, Iterator end) {
+		views.clear();
+		for(; begin != end; ++begin) {
+			views.push_back(StringView {begin->data(), (size_t)begin->size()});
 		}
+		return parse(views.data(), views.size());
 	}
-	return valid;
-}
+	bool parseSweep(int argc, const char* argv[], Sweep& variants);
 
-void Parser::printOptionsUsage() {
-	CLI_LOG_USAGE("Options:\n");
-	for(Option& opt : options) {
-		if(opt.requiresParameter()) {
-			CLI_LOG_USAGE("  -%c, --%s <%s>\t%s", opt.shortName, opt.longName, optionTypeDisplayName(opt.type), opt.description);
-		} else {
-			CLI_LOG_USAGE("  -%c, --%s\t%s", opt.shortName, opt.longName, opt.description);
-		}
-		if(opt.isRequired) {
-			CLI_LOG_USAGE(" (required)");
-		}
-		CLI_LOG_USAGE("\n");
-	}		
-}
+	// Restores every bound variable to the value it had before the first
+	// validate() call and forgets the previous parse
+	void reset();
+	// Parses a command line like a fresh parse() call, reusing the cached
+	// outcome of a line with identical options
+	bool validate(int argc, const char* argv[], ValidationCache& cache);
+	// Validates each line, storing its outcome in results.  Returns the number of valid lines.
+	size_t validateBatch(const CommandLine* lines, size_t count, bool* results, ValidationCache& cache);
+	bool validatePathOptions();
+	void printOptionsUsage();
 
-int Parser::applyOption(Option& opt, int argc, const char** argv) {
-	if(opt.type != Option::Type::FlagCount && opt.isSet) {
-		CLI_LOG_ERROR("error: option -%c/--%s shouldn't be specified more than once\n", opt.shortName, opt.longName);
-		return -1;
+	// Descriptions of the options created with a NULL description, from a
+	// table written by encodeDescriptions().  The table is only decompressed
+	// when a description is needed, and must stay valid until then.
+	void setDescriptions(const unsigned char* table, size_t length) {
+		descriptionTable = table;
+		descriptionTableLength = length;
 	}
-	opt.isSet = true;
-	// Other types expect an argument
-	if(opt.requiresParameter() && argc < 2) {
-		CLI_LOG_ERROR("error: option -%c/--%s requires a parameter\n", opt.shortName, opt.longName);
-		return -1;
+	// Same with the table in a file, which is only read when needed
+	void setDescriptionFile(const char* path) {
+		descriptionFile = path;
 	}
+	// Description of an option by long name, NULL if there's none
+	const char* description(const char* longName);
 
-	const char* argParam = argv[1];
-
-	switch(opt.type) {
-		case Option::Type::Flag:
-			opt.as<bool>() = true;
-			return 0;
-		case Option::Type::FlagCount:
-			opt.as<int>()++;
-			return 0;
-		case Option::Type::Int:
-			if(!isNumeric(argParam, false)) {
-				CLI_LOG_ERROR("error: invalid integer value \"%s\" specified for option -%c/--%s\n", argParam, opt.shortName, opt.longName);
-				return -1;
-			}
-			opt.as<int>() = atoi(argParam);
-			return 1;
-		case Option::Type::Float:
-			if(!isNumeric(argParam, true)) {
-				CLI_LOG_ERROR("error: invalid float value \"%s\" specified for option -%c/--%s\n", argParam, opt.shortName, opt.longName);
-				return -1;
-			}
-			opt.as<float>() = atof(argParam);
-			return 1;
-		case Option::Type::PathExisting:
-			if(!checkExistsReadable(argParam)) {
-				CLI_LOG_ERROR("error: invalid path \"%s\" specified for option -%c/--%s.  Path must point to an existing, readable file\n", argParam, opt.shortName, opt.longName);
-				return -1;
-			}
-		case Option::Type::String:
-		case Option::Type::Path:
-			opt.as<const char*>() = argParam;
-			return 1;
+	const std::vector<const char*>& getRemainingArgs() const {
+		return remaining;
 	}
-	return 0;
-}
+	// Hash of the types and names of the options, identifies the spec in capture logs
+	uint64_t fingerprint() const;
 
-bool Parser::isNumeric(const char* str, bool floatingPoint) {
-	bool beginExponent = false;
-	bool foundDecimal = false;
-	for(int i = 0; i < strlen(str); ++i) {
-		switch(str[i]) {
-			case '0':
-			case '1':
-			case '2':
-			case '3':
-			case '4':
-			case '5':
-			case '6':
-			case '7':
-			case '8':
-			case '9':
-				continue;
-			case '-':
-			case '+':
-				if(i == 0 || (floatingPoint && beginExponent)) {
-					continue;
-				}
-				return false;
-			case '.':
-				if(floatingPoint && !foundDecimal) {
-					foundDecimal = true;
-					continue;
-				}
-				return false;
-			case 'e':
-			case 'E':
-				if(floatingPoint) {
-					beginExponent = true;
-					floatingPoint = false;
-				}
-				return false;
-			default:
-				return false;
-		}
+	// Whether the option at the given index of the spec was given
+	bool isSet(size_t option) const {
+		return option < options.size() && options[option].isSet;
 	}
-	return true;
-}
 
-int Parser::handleOption(int argc, const char** argv) {
-	const char* arg = argv[0];
-	if(strlen(arg) > 1 && arg[0] == '-') {
-		// Handle concatenated short options
-		if(arg[1] != '-') {
-			for(int i = 1; i < strlen(arg); ++i) {
-				bool handled = false;
-				for(Option& opt : options) {
-					if(opt.shortName == arg[i]) {
-						// arguments requiring parameters can't be in the middle of the list
-						if(opt.requiresParameter() && i < strlen(arg) - 1) {
-							CLI_LOG_ERROR("error: short option -%c cannot be used in the middle of a flag list, it requires a value\n", opt.shortName);
-							return -1;
-						}
-						handled = true;
-						int result = applyOption(opt, argc, argv);
-						if(result != 0) return result;
-					}
-				}
-				if(!handled) {
-					CLI_LOG_ERROR("error: unknown short option -%c\n", arg[i]);
-					return -1;
-				}
-			}
-		} else {
-			for(Option& opt : options) {
-				if(strcmp(arg+2, opt.longName) == 0) {
-					return applyOption(opt, argc, argv);
-				}
+	// Whether any option of the spec reads files, fds or the file system
+	bool hasSideEffects() const {
+		for(const Option& opt : options) {
+			if(opt.hasSideEffects()) {
+				return true;
 			}
-			CLI_LOG_ERROR("error: unknown option %s\n", argv[0]);
-			return -1;
 		}
-	} else {
-		remaining.push_back(arg);
+		return false;
 	}
-	return 0;
-}
 
-const char* Parser::optionTypeDisplayName(Option::Type type) {
-	switch(type) {
-		case Option::Type::Flag:
-		case Option::Type::FlagCount:
-			return "flag";
-		case Option::Type::Int:
-			return "integer";
-		case Option::Type::Float:
-			return "float";
-		case Option::Type::String:
-			return "string";
-		case Option::Type::Path:
-		case Option::Type::PathExisting:
-			return "path";
-		default:
-			return "unknown";
+	// Unknown options (and their attached values) are collected for forwarding
+	// instead of being errors.  Values passed as a separate argument can't be
+	// told apart from positional arguments, they're only forwarded along with
+	// the other positional arguments if forwardPositionals is set.
+	void passThroughUnknownOptions(bool forwardPositionals = false) {
+		passThroughMode = forwardPositionals ? PassThrough::OptionsAndPositionals : PassThrough::Options;
 	}
-}
 
-bool Parser::checkExistsReadable(const char* path) {
-	FILE* f = fopen(path, "rb");
-	if(f != NULL) {
-		fclose(f);
-		return true;
-	} else {
-		return false;
+	// Policy for options repeated on the command line that don't set their own
+	void setRepeatPolicy(RepeatPolicy policy) {
+		repeatPolicy = policy == RepeatPolicy::Default ? RepeatPolicy::Error : policy;
 	}
-}
 
-Option OptionFlag(char shortName, const char* longName, const char* description, bool* valuePointer){
-	return Option {Option::Type::Flag, shortName, longName, description, false, false, valuePointer};
-}
+	// Every value given to an option with the Accumulate policy, in order
+	std::vector<const char*> getValues(const char* longName);
 
-Option OptionFlagCount(char shortName, const char* longName, const char* description, int* valuePointer){
-	return Option {Option::Type::FlagCount, shortName, longName, description, false, false, valuePointer};
-}
+	// In lazy mode parse() only records the value given to each option, it is
+	// converted into the bound variable by the first get() call for the option.
+	// Options that read files, fds or the file system are still converted by parse().
+	void setLazy(bool enabled) {
+		lazy = enabled;
+	}
 
-Option OptionInt(char shortName, const char* longName, const char* description, bool required, int* valuePointer){
-	return Option {Option::Type::Int, shortName, longName, description, required, false, valuePointer};
-}
+	// The variable bound to an option, after converting its value if that
+	// hasn't been done yet.  NULL if the value is invalid or there's no such option.
+	template<typename T>
+	T* get(const char* longName) {
+		Option* opt = convertLazyOption(longName);
+		return opt != nullptr ? &opt->as<T>() : nullptr;
+	}
 
-Option OptionFloat(char shortName, const char* longName, const char* description, bool required, float* valuePointer){
-	return Option {Option::Type::Float, shortName, longName, description, required, false, valuePointer};
-}
+	// Forwarded arguments as ranges of indices in the parsed argv
+	const std::vector<ArgumentRange>& getPassThroughRanges() const {
+		return passThroughRanges;
+	}
 
-Option OptionString(char shortName, const char* longName, const char* description, bool required, const char** valuePointer){
-	return Option {Option::Type::String, shortName, longName, description, required, false, valuePointer};
-}
+	// Forwarded arguments as a NULL-terminated argv for execv(), starting with program
+	const char* const* getPassThroughArgv(const char* program) {
+		passThroughArgv[0] = program;
+		return passThroughArgv.data();
+	}
 
-Option OptionPath(char shortName, const char* longName, const char* description, bool required, const char** valuePointer){
-	return Option {Option::Type::Path, shortName, longName, description, required, false, valuePointer};
-}
+private:
+	std::vector<Option> options;
+	// long names sorted for binary search
+	std::vector<OptionName> longNames;
+	std::vector<const char*> remaining;
+	std::vector<std::vector<unsigned char>> storage;
+	// shared by copies of the parser, whose values point into them
+	std::vector<std::shared_ptr<MappedFile>> mappedFiles;
+	std::vector<std::shared_ptr<LockedBuffer>> lockedBuffers;
+	const char* executableName;
+	const char** arguments;
+	// length of each argument, by argv index
+	std::vector<size_t> argumentLengths;
+	// false while parsing arguments that aren't NUL-terminated
+	bool argumentsTerminated;
+	std::vector<StringView> views;
+	std::vector<const char*> viewArguments;
+	size_t nextPositional;
+	// argv indices of the arguments collected by a Remaining option
+	std::vector<int> listIndices;
+	// set while parsing a sweep
+	Sweep* sweep;
+	enum class PassThrough {
+		None,
+		Options,
+		OptionsAndPositionals
+	};
+	PassThrough passThroughMode;
+	std::vector<ArgumentRange> passThroughRanges;
+	// the program, the forwarded arguments and a NULL terminator
+	std::vector<const char*> passThroughArgv;
+	RepeatPolicy repeatPolicy;
+	// classification of each argument, by argv index
+	std::vector<Token> tokens;
+	int currentIndex;
+	// argv index of the last occurrence of each LastWins option
+	std::vector<int> lastOccurrences;
+	// (option index, value) of options accumulating their values
+	std::vector<std::pair<size_t, const char*>> accumulatedValues;
+	// values of the bound variables before validating, by option
+	std::vector<unsigned char> defaults;
+	std::vector<size_t> defaultOffsets;
+	// positional arguments are handled after the options while validating
+	bool deferPositionals;
+	std::vector<int> deferredPositionals;
+	// option indices by short name, shortIndices[shortOffsets[c]] to shortIndices[shortOffsets[c+1]]
+	uint32_t shortOffsets[257];
+	std::vector<uint32_t> shortIndices;
+	// positional options in order, options checked after parsing
+	std::vector<size_t> positionalIndices;
+	std::vector<size_t> finishIndices;
+	bool hasLastWinsOption;
+	bool hasDefaultPolicyOption;
+	// values recorded in lazy mode, in order, and conversion states by option
+	struct LazyValue {
+		size_t option;
+		StringView value;
+	};
+	bool lazy;
+	std::vector<LazyValue> lazyValues;
+	enum class LazyState {
+		Pending,
+		Converted,
+		Invalid
+	};
+	std::unordered_map<size_t, LazyState> lazyStates;
+	// usage counters, mapped on the first parse when enabled and shared by copies
+	bool usageChecked;
+	std::shared_ptr<UsageSegment> usage;
+	// descriptions waiting to be decompressed, and the decompressed text
+	const unsigned char* descriptionTable;
+	size_t descriptionTableLength;
+	const char* descriptionFile;
+	std::vector<char> descriptionText;
 
-Option OptionPathExisting(char shortName, const char* longName, const char* description, bool required, const char** valuePointer){
-	return Option {Option::Type::PathExisting, shortName, longName, description, required, false, valuePointer};
-}
+	friend class Sweep;
+	friend class CompositeParser;
+	friend class ValidationCache;
+	friend class SharedValues;
+	friend class UsageSegment;
+
+	bool parseArguments(int argc, const char** argv);
+	bool handleDeferredPositionals();
+	void capture(int argc, const char** argv);
+	void loadDescriptions();
+	void countUsage(const Option& opt) {
+		if(usage) {
+			usage->increment(usage->counters() + (&opt - options.data()));
+		}
+	}
+
+	void buildNameIndex();
+	Option* findLongOption(const char* name, size_t length);
+	Option* convertLazyOption(const char* longName);
+	void beginParse(int argc, const char** argv);
+	RepeatPolicy repeatPolicyOf(const Option& opt) const {
+		return opt.repeatPolicy == RepeatPolicy::Default ? repeatPolicy : opt.repeatPolicy;
+	}
+	void findLastOccurrences(int argc);
+	bool finishParse();
+	int applyShortOption(Option& opt, const Token& token, size_t index, int argc, const char** argv, bool& consumedList);
+
+	int applyOption(Option& opt, StringView attachedValue, int argc, const char** argv);
+	bool applyValue(Option& opt, StringView value);
+	bool convertValue(Option& opt, StringView value);
+	bool convertValue(Option& opt, const char* value) {
+		return convertValue(opt, StringView {value, strlen(value)});
+	}
+	StringView argumentView(int index) const;
+	const char* terminated(StringView value);
+	enum class DecimalResult {
+		Ok,
+		Invalid,
+		OutOfRange,
+		TooPrecise
+	};
+	DecimalResult parseDecimal(StringView str, int fractionalDigits, int64_t& value);
+	bool parseInt64(StringView str, int64_t& value);
+	bool parseInt64(const char* str, int64_t& value) {
+		return parseInt64(StringView {str, strlen(str)}, value);
+	}
+	bool parseDouble(StringView str, double& value);
+	bool decodeBlob(Option& opt, StringView value);
+	bool loadValueFile(Option& opt, const char* path);
+	bool readSecret(Option& opt, StringView fdValue);
+	bool compilePattern(Option& opt, StringView pattern);
+	unsigned char* allocate(size_t size);
+	Token classifyToken(const char* arg, size_t length);
+	Token classifyToken(const char* arg) {
+		return classifyToken(arg, strlen(arg));
+	}
+	int handleOption(int argc, const char** argv, int index);
+	bool handlePositional(StringView arg, int index);
+	void passThrough(int index);
+	bool convertList(Option& opt);
+	bool parseShard(Option& opt, StringView value);
+	const char* optionTypeDisplayName(Option::Type type);
+	bool checkExistsReadable(const char* path);
+
+};
+
+// Variants of a command line parsed with Parser::parseSweep().  Option values
+// can be swept with an integer range {first..last} or {first..last..step}, a
+// list {a,b,c} or, for numeric options, a bare list a,b,c.  The sweep is the
+// cartesian product of all swept values, with the last swept option varying
+// fastest.
+//
+// Selecting a variant converts only the swept values of that variant into
+// their variables, in constant time for a given number of swept options.  The
+// Sweep refers to the Parser, which must outlive it.  String values produced
+// by a range are only valid until the next variant is selected.
+class Sweep {
+public:
+	Sweep() : parser(nullptr) {}
+
+	// Number of variants, 1 if nothing was swept
+	size_t size() const;
+	size_t sweptOptionCount() const {
+		return axes.size();
+	}
+	// Converts the values of a variant into the bound variables
+	bool select(size_t variant);
+
+	// Iterates over the variants, dereferencing selects the variant and returns its index
+	class iterator {
+	public:
+		iterator(Sweep* sweep, size_t variant) : sweep(sweep), variant(variant) {}
+		size_t operator*() const {
+			sweep->select(variant);
+			return variant;
+		}
+		iterator& operator++() {
+			++variant;
+			return *this;
+		}
+		bool operator!=(const iterator& other) const {
+			return variant != other.variant;
+		}
+		bool operator==(const iterator& other) const {
+			return variant == other.variant;
+		}
+	private:
+		Sweep* sweep;
+		size_t variant;
+	};
+
+	iterator begin() {
+		return iterator(this, 0);
+	}
+	iterator end() {
+		return iterator(this, size());
+	}
+
+private:
+	friend class Parser;
+
+	struct Axis {
+		size_t option;
+		size_t count;
+		bool isRange;
+		int64_t first;
+		int64_t step;
+		size_t firstItem;	// index in itemOffsets of the first listed value
+		char formatted[24];
+	};
+
+	Parser* parser;
+	std::vector<Axis> axes;
+	// listed values, NUL-terminated and shared by every variant
+	std::vector<char> strings;
+	std::vector<size_t> itemOffsets;
+
+	void clear();
+	bool addAxis(Option& opt, const char* value);
+	bool addRange(Axis& axis, Option& opt, const char* value, size_t length);
+	bool applyItem(Axis& axis, size_t index);
+	const char* item(size_t index) const {
+		return strings.data() + itemOffsets[index];
+	}
+};
+
+// Parses a single command line for several Parsers, typically one per
+// component of a program.  The option names of the parsers are merged into one
+// index when the CompositeParser is built, names defined by more than one
+// parser are reported then.  Each argument is routed to the parser that owns
+// it in a single pass, positional arguments go to the last parser.  Parsers
+// must outlive the CompositeParser.
+class CompositeParser {
+public:
+	CompositeParser(std::initializer_list<Parser*> parsers);
+
+	bool parse(int argc, const char* argv[]);
+
+	// true if several parsers define the same option name, parse() fails then
+	bool hasConflicts() const {
+		return conflicts;
+	}
+
+	const std::vector<const char*>& getRemainingArgs() const {
+		return parsers.back()->getRemainingArgs();
+	}
+
+private:
+	struct Route {
+		OptionName name;
+		size_t parser;
+	};
+
+	std::vector<Parser*> parsers;
+	std::vector<Route> longNames;
+	// parser index + 1 owning each short name, 0 if none
+	unsigned char shortNames[256];
+	bool conflicts;
+
+	int handleOption(int argc, const char** argv, int index);
+};
+
+// Outcomes of validated command lines, keyed by the arguments that can affect
+// option parsing (options and the arguments that follow them).  Positional
+// arguments are only counted, so lines that differ only in positional
+// arguments share an entry.  An entry holds whether the options were valid and
+// the compact values of the options that were set.  Entries are evicted with
+// the CLOCK algorithm once capacity is reached.
+//
+// Only lines setting flag, integer, floating point, decimal, string and path
+// options are cached.  Errors are only logged when a line is first seen.  A
+// cache must only be used with a single Parser.
+class ValidationCache {
+public:
+	explicit ValidationCache(size_t capacity) : capacity(capacity), hand(0), owner(nullptr), hits(0), misses(0) {}
+
+	size_t size() const {
+		return entries.size();
+	}
+	size_t hitCount() const {
+		return hits;
+	}
+	size_t missCount() const {
+		return misses;
+	}
+	void clear();
+
+private:
+	friend class Parser;
+
+	// Value of an option set by a cached line
+	struct Value {
+		uint32_t option;
+		uint32_t offset;	// in Entry::data
+		int32_t token;		// argv index a string points into, -1 if it doesn't
+		size_t tokenOffset;
+	};
+
+	struct Entry {
+		uint64_t hash;
+		std::vector<char> key;
+		bool valid;
+		bool referenced;
+		std::vector<Value> values;
+		std::vector<unsigned char> data;
+		std::vector<int> positionals;	// argv indices
+	};
+
+	size_t capacity;
+	size_t hand;
+	const Parser* owner;
+	std::vector<Entry> entries;
+	std::unordered_map<uint64_t, size_t> slots;
+	std::vector<char> key;
+	size_t hits;
+	size_t misses;
+
+	uint64_t buildKey(Parser& parser, int argc, const char** argv);
+	Entry* find(uint64_t hash);
+	Entry& insert(uint64_t hash);
+};
+
+// Read-only snapshot of the values of a parsed command line in a sealed
+// memory file (memfd, Linux only), so that forked or exec'd workers can share
+// one copy of a large configuration instead of touching the bound variables.
+// The snapshot holds whether each option is set and the values of scalar,
+// string, path and blob options, looked up by long name.  Secrets are never
+// exported.  The descriptor is close-on-exec, clear FD_CLOEXEC to pass it to
+// an exec'd program that calls open() with it.
+class SharedValues {
+public:
+	SharedValues() : data(nullptr), length(0), descriptor(-1) {}
+	SharedValues(SharedValues&& other);
+	SharedValues& operator=(SharedValues&& other);
+	SharedValues(const SharedValues&) = delete;
+	SharedValues& operator=(const SharedValues&) = delete;
+	~SharedValues();
+
+	// Writes the values of a parsed Parser into a new sealed memfd and maps it
+	bool create(const Parser& parser);
+	// Maps a snapshot read-only.  The descriptor isn't closed.  Fails unless
+	// the memfd is sealed against writes and shrinking and every record lies
+	// within the snapshot, so fds from other processes can be opened safely.
+	bool open(int fd);
+
+	int fd() const {
+		return descriptor;
+	}
+	size_t size() const {
+		return length;
+	}
+
+	bool isSet(const char* longName) const;
+	// Value of a flag, integer, floating point or decimal option, NULL if
+	// there's no such option or T doesn't match its size
+	template<typename T>
+	const T* get(const char* longName) const {
+		return (const T*)scalar(longName, sizeof(T));
+	}
+	// Value of a string or path option, NULL if it isn't set
+	const char* getString(const char* longName) const;
+	// Value of a Hex or Base64 option
+	Blob getBlob(const char* longName) const;
+
+private:
+	struct Header {
+		uint32_t magic;
+		uint32_t version;
+		uint64_t size;
+		uint32_t count;
+		uint32_t reserved;
+	};
+	// Records follow the header, sorted by name
+	struct Record {
+		uint32_t nameOffset;
+		uint32_t nameLength;
+		uint32_t valueOffset;
+		uint32_t valueLength;
+		uint8_t type;
+		uint8_t isSet;
+		uint16_t reserved;
+	};
+
+	const unsigned char* data;
+	size_t length;
+	int descriptor;
+
+	const Record* find(const char* longName) const;
+	const void* scalar(const char* longName, size_t size) const;
+	static bool isValid(const unsigned char* data, size_t size);
+	void close();
+};
+
+}; // end namespace
+
+#endif // CLI_DECLARATION
+
+#if defined(CLI_IMPLEMENTATION) && !defined(_CLI_IMPLEMENTATION_INCLUSION_GUARD)
+#define _CLI_IMPLEMENTATION_INCLUSION_GUARD
+
+// Define CLI_NO_SIMD to only use the portable decoders
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__)) && !defined(CLI_NO_SIMD)
+#define CLI_SIMD_SSSE3 1
+#include <tmmintrin.h>
+#endif
+
+// The optional parts of the implementation are only compiled when enabled
+#if defined(CLI_ENABLE_ALL)
+#ifndef CLI_ENABLE_THREADS
+#define CLI_ENABLE_THREADS 1
+#endif
+#ifndef CLI_ENABLE_PATTERNS
+#define CLI_ENABLE_PATTERNS 1
+#endif
+#ifndef CLI_ENABLE_SWEEPS
+#define CLI_ENABLE_SWEEPS 1
+#endif
+#ifndef CLI_ENABLE_COMPOSITE
+#define CLI_ENABLE_COMPOSITE 1
+#endif
+#ifndef CLI_ENABLE_VALIDATION_CACHE
+#define CLI_ENABLE_VALIDATION_CACHE 1
+#endif
+#ifndef CLI_ENABLE_SHARED_VALUES
+#define CLI_ENABLE_SHARED_VALUES 1
+#endif
+#ifndef CLI_ENABLE_USAGE_COUNTERS
+#define CLI_ENABLE_USAGE_COUNTERS 1
+#endif
+#ifndef CLI_ENABLE_CAPTURE
+#define CLI_ENABLE_CAPTURE 1
+#endif
+#ifndef CLI_ENABLE_DESCRIPTIONS
+#define CLI_ENABLE_DESCRIPTIONS 1
+#endif
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <limits.h>
+
+// Without CLI_ENABLE_THREADS all the work is done on the calling thread
+#if defined(CLI_ENABLE_THREADS)
+#include <thread>
+#endif
+
+namespace cli {
+
+// Number of chunks to split count items into, at least minChunk items each
+static size_t parallelChunkCount(size_t count, size_t minChunk) {
+	size_t chunks = 1;
+#if defined(CLI_ENABLE_THREADS)
+	size_t threads = std::thread::hardware_concurrency();
+	chunks = count / minChunk;
+	if(chunks > threads) chunks = threads;
+	if(chunks < 1) chunks = 1;
+#else
+	(void)count;
+	(void)minChunk;
+#endif
+	return chunks;
+}
+
+// Calls fn(chunk, begin, end) for each chunk, the first one on the calling thread
+template<typename F>
+static void parallelChunks(size_t count, size_t chunks, F fn) {
+#if defined(CLI_ENABLE_THREADS)
+	std::vector<std::thread> threads;
+	for(size_t chunk = 1; chunk < chunks; ++chunk) {
+		threads.emplace_back(fn, chunk, count * chunk / chunks, count * (chunk + 1) / chunks);
+	}
+	fn(0, 0, count / chunks);
+	for(std::thread& thread : threads) {
+		thread.join();
+	}
+#else
+	(void)chunks;
+	fn(0, 0, count);
+#endif
+}
+
+}; // end namespace
+
+#if defined(__unix__) || defined(__APPLE__)
+#define CLI_HAS_MMAP 1
+#if defined(__linux__)
+#define CLI_HAS_MEMFD 1
+#endif
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#if defined(__linux__) && !(defined(__GLIBC__) && defined(_GNU_SOURCE)) && (defined(CLI_ENABLE_USAGE_COUNTERS) || defined(CLI_ENABLE_CAPTURE))
+#include <sys/auxv.h>
+#endif
+
+namespace cli {
+
+#if defined(CLI_ENABLE_USAGE_COUNTERS) || defined(CLI_ENABLE_CAPTURE)
+// Environment variable, ignored in setuid and setgid processes where the
+// caller would choose files written with the tool's privileges
+static const char* secureGetenv(const char* name) {
+#if defined(__GLIBC__) && defined(_GNU_SOURCE)
+	return secure_getenv(name);
+#elif defined(__linux__)
+	return getauxval(AT_SECURE) != 0 ? nullptr : getenv(name);
+#elif defined(__APPLE__) || defined(__FreeBSD__) || defined(__OpenBSD__) || defined(__NetBSD__)
+	return issetugid() ? nullptr : getenv(name);
+#else
+	return getenv(name);
+#endif
+}
+#endif
+
+#if defined(CLI_ENABLE_USAGE_COUNTERS)
+// Directory of the usage segments, read from the environment on first use
+static const char*& usageDirectory() {
+	static const char* path = secureGetenv("CLI_USAGE_DIR");
+	return path;
+}
+#endif
+
+bool Parser::parse(int argc, const char* argv[]) {
+	beginParse(argc, argv);
+	bool valid = parseArguments(argc, argv) && finishParse();
+	capture(argc, argv);
+	return valid;
+}
+
+bool Parser::parse(const StringView* args, size_t count) {
+	viewArguments.resize(count);
+	for(size_t i = 0; i < count; ++i) {
+		viewArguments[i] = args[i].data;
+	}
+	beginParse((int)count, viewArguments.data());
+	argumentsTerminated = false;
+	argumentLengths.resize(count);
+	for(size_t i = 0; i < count; ++i) {
+		argumentLengths[i] = args[i].length;
+	}
+	executableName = count > 0 ? terminated(args[0]) : nullptr;
+	bool valid = parseArguments((int)count, viewArguments.data()) && finishParse();
+	argumentsTerminated = true;
+	return valid;
+}
+
+bool Parser::parseArguments(int argc, const char** argv) {
+	// NUL-terminated arguments are measured once
+	if(argumentLengths.size() != (size_t)(argc > 0 ? argc : 0)) {
+		argumentLengths.resize(argc > 0 ? argc : 0);
+		for(int i = 0; i < argc; ++i) {
+			argumentLengths[i] = strlen(argv[i]);
+		}
+	}
+	// each argument is classified once, the classification is shared by all passes
+	tokens.resize(argc > 0 ? argc : 0);
+	for(int i = 1; i < argc; ++i) {
+		tokens[i] = classifyToken(argv[i], argumentLengths[i]);
+	}
+	findLastOccurrences(argc);
+
+	for(int i = 1; i < argc; ++i) {
+		currentIndex = i;
+		int result = handleOption(argc-i,argv+i, i);
+		// error
+		if(result < 0) return false;
+		// skip any consumed parameters
+		i+= result;
+	}
+	return true;
+}
+
+void Parser::beginParse(int argc, const char** argv) {
+#if defined(CLI_ENABLE_USAGE_COUNTERS)
+	if(!usageChecked) {
+		usageChecked = true;
+		const char* directory = usageDirectory();
+		if(directory != nullptr && *directory != '\0') {
+			std::shared_ptr<UsageSegment> segment(new UsageSegment());
+			if(segment->attach(directory, *this)) {
+				usage = segment;
+			}
+		}
+	}
+	if(usage) {
+		usage->increment(&usage->header->parses);
+	}
+#endif
+	// an empty command line has no program name, and argv may be NULL
+	executableName = argc > 0 ? argv[0] : nullptr;
+	arguments = argv;
+	argumentLengths.clear();
+	argumentsTerminated = true;
+	lastOccurrences.clear();
+	passThroughRanges.clear();
+	passThroughArgv.assign(2, nullptr);
+	accumulatedValues.clear();
+}
+
+// Pre-pass over the classified arguments finding where LastWins options last
+// occur, so their earlier values can be skipped without converting them
+void Parser::findLastOccurrences(int argc) {
+	// lazy parsing keeps the last recorded value
+	bool hasLastWins = hasLastWinsOption || (repeatPolicy == RepeatPolicy::LastWins && hasDefaultPolicyOption);
+	if(!hasLastWins || lazy) {
+		return;
+	}
+	lastOccurrences.assign(options.size(), 0);
+	for(int i = 1; i < argc; ++i) {
+		const Token& token = tokens[i];
+		int index = i;
+		if(token.kind == Token::Kind::Long) {
+			if(Option* opt = findLongOption(token.name, token.nameLength)) {
+				lastOccurrences[opt - options.data()] = index;
+				if(token.value == nullptr && opt->requiresParameter()) ++i;
+			}
+		} else if(token.kind == Token::Kind::Short) {
+			bool consumedList = false;
+			for(size_t c = 0; c < token.nameLength && !consumedList; ++c) {
+				unsigned char shortName = (unsigned char)token.name[c];
+				for(uint32_t o = shortOffsets[shortName]; o < shortOffsets[shortName + 1]; ++o) {
+					Option& opt = options[shortIndices[o]];
+					lastOccurrences[&opt - options.data()] = index;
+					consumedList = opt.hasOptionalValue();
+					if(opt.requiresParameter() && c == token.nameLength - 1) ++i;
+				}
+			}
+		}
+	}
+}
+
+std::vector<const char*> Parser::getValues(const char* longName) {
+	std::vector<const char*> values;
+	Option* opt = findLongOption(longName, strlen(longName));
+	if(opt != nullptr) {
+		size_t option = (size_t)(opt - options.data());
+		for(const std::pair<size_t, const char*>& value : accumulatedValues) {
+			if(value.first == option) values.push_back(value.second);
+		}
+	}
+	return values;
+}
+
+// Converts the collected lists and checks for required options
+bool Parser::finishParse() {
+	for(size_t index : finishIndices) {
+		Option& opt = options[index];
+		if(opt.isList() && opt.isSet && !convertList(opt)) {
+			return false;
+		}
+	}
+	// file lists are indexed once their shard is known
+	for(size_t index : finishIndices) {
+		Option& opt = options[index];
+		if(opt.type == Option::Type::FilesFrom && opt.isSet && !opt.as<FileList>().load()) {
+			CLI_LOG_ERROR("error: unable to read file \"%s\" specified for option -%c/--%s\n", opt.as<FileList>().path, opt.shortName, opt.longName);
+			return false;
+		}
+	}
+	for(size_t index : finishIndices) {
+		Option& opt = options[index];
+		if(opt.isRequired && !opt.isSet) {
+			if(opt.isPositional) {
+				CLI_LOG_ERROR("error: argument <%s> is required\n", opt.longName);
+			} else {
+				CLI_LOG_ERROR("error: option -%c/--%s is required\n", opt.shortName, opt.longName);
+			}
+			return false;
+		}
+	}
+	return true;
+}
+
+#if defined(CLI_ENABLE_SWEEPS)
+bool Parser::parseSweep(int argc, const char* argv[], Sweep& variants) {
+	variants.clear();
+	variants.parser = this;
+	sweep = &variants;
+	bool parsed = parse(argc, argv);
+	sweep = nullptr;
+	// rebind values that may point into the variant storage
+	return parsed && variants.select(0);
+}
+#endif
+
+bool Parser::validatePathOptions() {
+	bool valid = true;
+	for(Option& opt: options) {
+		if(opt.type == Option::Type::PathExisting && !checkExistsReadable(opt.as<const char*>())) {
+			valid = false;
+			CLI_LOG_ERROR("error: option -%c/--%s requires a readable file\n", opt.shortName, opt.longName);
+		}
+	}
+	return valid;
+}
+
+void Parser::printOptionsUsage() {
+	loadDescriptions();
+	bool hasPositionals = false;
+	CLI_LOG_USAGE("Options:\n");
+	for(Option& opt : options) {
+		if(opt.isPositional) {
+			hasPositionals = true;
+			continue;
+		}
+		// missing when no table provides it
+		const char* description = opt.description != nullptr ? opt.description : "";
+		if(opt.hasOptionalValue()) {
+			CLI_LOG_USAGE("  -%c, --%s[=<%s>]\t%s", opt.shortName, opt.longName, optionTypeDisplayName(opt.type), description);
+		} else if(opt.requiresParameter()) {
+			CLI_LOG_USAGE("  -%c, --%s <%s>\t%s", opt.shortName, opt.longName, optionTypeDisplayName(opt.type), description);
+		} else {
+			CLI_LOG_USAGE("  -%c, --%s\t%s", opt.shortName, opt.longName, description);
+		}
+		if(opt.isRequired) {
+			CLI_LOG_USAGE(" (required)");
+		}
+		CLI_LOG_USAGE("\n");
+	}		
+	if(hasPositionals) {
+		CLI_LOG_USAGE("Arguments:\n");
+		for(Option& opt : options) {
+			if(!opt.isPositional) continue;
+			const char* description = opt.description != nullptr ? opt.description : "";
+			CLI_LOG_USAGE("  <%s%s>\t%s (%s)", opt.longName, opt.isList() ? "..." : "", description, optionTypeDisplayName(opt.type));
+			if(opt.isRequired) {
+				CLI_LOG_USAGE(" (required)");
+			}
+			CLI_LOG_USAGE("\n");
+		}
+	}
+}
+
+const char* Parser::description(const char* longName) {
+	loadDescriptions();
+	for(const Option& opt : options) {
+		if(opt.longName != nullptr && strcmp(opt.longName, longName) == 0) {
+			return opt.description;
+		}
+	}
+	return nullptr;
+}
+
+#if defined(CLI_ENABLE_DESCRIPTIONS)
+// Fills in the missing descriptions from the table, once
+void Parser::loadDescriptions() {
+	if(descriptionTable == nullptr && descriptionFile == nullptr) {
+		return;
+	}
+	bool valid;
+	if(descriptionTable != nullptr) {
+		valid = decodeDescriptions(descriptionTable, descriptionTableLength, descriptionText);
+	} else {
+		MappedFile file;
+		valid = file.open(descriptionFile) && decodeDescriptions((const unsigned char*)file.data, file.length, descriptionText);
+	}
+	descriptionTable = nullptr;
+	descriptionFile = nullptr;
+	if(!valid) {
+		CLI_LOG_ERROR("error: invalid option descriptions\n");
+		descriptionText.clear();
+		return;
+	}
+	const char* cursor = descriptionText.data();
+	const char* end = cursor + descriptionText.size();
+	while(cursor < end) {
+		const char* name = cursor;
+		size_t nameLength = strlen(name);
+		const char* text = name + nameLength + 1;
+		cursor = text + strlen(text) + 1;
+		Option* opt = findLongOption(name, nameLength);
+		if(opt == nullptr) {
+			for(size_t index : positionalIndices) {
+				if(strcmp(options[index].longName, name) == 0) {
+					opt = &options[index];
+					break;
+				}
+			}
+		}
+		if(opt != nullptr && opt->description == nullptr) {
+			opt->description = text;
+		}
+	}
+}
+#else
+void Parser::loadDescriptions() {
+	if(descriptionTable != nullptr || descriptionFile != nullptr) {
+		CLI_LOG_ERROR("error: option descriptions need CLI_ENABLE_DESCRIPTIONS\n");
+		descriptionTable = nullptr;
+		descriptionFile = nullptr;
+	}
+}
+#endif
+
+int Parser::applyOption(Option& opt, StringView attachedValue, int argc, const char** argv) {
+	RepeatPolicy policy = repeatPolicyOf(opt);
+	bool repeated = opt.type != Option::Type::FlagCount && opt.isSet;
+	if(repeated && policy == RepeatPolicy::Error) {
+		CLI_LOG_ERROR("error: option -%c/--%s shouldn't be specified more than once\n", opt.shortName, opt.longName);
+		return -1;
+	}
+	opt.isSet = true;
+	countUsage(opt);
+	// values that are overridden are consumed without converting them
+	bool skip = (repeated && policy == RepeatPolicy::FirstWins) ||
+		(policy == RepeatPolicy::LastWins && !lastOccurrences.empty() && lastOccurrences[&opt - options.data()] > currentIndex);
+
+	switch(opt.type) {
+		case Option::Type::Flag:
+			opt.as<bool>() = true;
+			return 0;
+		case Option::Type::FlagCount:
+			opt.as<int>()++;
+			return 0;
+		default:
+			break;
+	}
+
+	// Attached and implicit values never consume the next argument
+	StringView value = attachedValue;
+	if(value.data == nullptr && opt.implicitValue != nullptr) {
+		value = StringView {opt.implicitValue, strlen(opt.implicitValue)};
+	}
+	int consumed = 0;
+	if(value.data == nullptr) {
+		// Other types expect an argument
+		if(argc < 2) {
+			CLI_LOG_ERROR("error: option -%c/--%s requires a parameter\n", opt.shortName, opt.longName);
+			return -1;
+		}
+		value = argumentView((int)(argv - arguments) + 1);
+		consumed = 1;
+	}
+	if(skip) {
+		return consumed;
+	}
+	if(policy == RepeatPolicy::Accumulate) {
+		accumulatedValues.push_back(std::make_pair((size_t)(&opt - options.data()), terminated(value)));
+	}
+	// options that read files or fds are converted while those are what the
+	// command line meant, file lists need their values to be loaded after parsing
+	if(lazy && sweep == nullptr && !opt.hasSideEffects()) {
+		lazyValues.push_back(LazyValue {(size_t)(&opt - options.data()), value});
+		lazyStates[lazyValues.back().option] = LazyState::Pending;
+		return consumed;
+	}
+	return applyValue(opt, value) ? consumed : -1;
+}
+
+bool Parser::applyValue(Option& opt, StringView value) {
+#if defined(CLI_ENABLE_SWEEPS)
+	if(sweep != nullptr) {
+		// sweeps are only parsed from NUL-terminated arguments
+		return sweep->addAxis(opt, value.data);
+	}
+#endif
+	return convertValue(opt, value);
+}
+
+bool Parser::parseEncoded(const unsigned char* data, size_t length) {
+	if(!decodeArguments(data, length, views)) {
+		CLI_LOG_ERROR("error: invalid encoded arguments\n");
+		return false;
+	}
+	return parse(views.data(), views.size());
+}
+
+StringView Parser::argumentView(int index) const {
+	if((size_t)index < argumentLengths.size()) {
+		return StringView {arguments[index], argumentLengths[index]};
+	}
+	return StringView {arguments[index], strlen(arguments[index])};
+}
+
+// The value itself when the arguments are NUL-terminated, else a copy
+const char* Parser::terminated(StringView value) {
+	if(argumentsTerminated || value.data == nullptr) {
+		return value.data;
+	}
+	char* copy = (char*)allocate(value.length + 1);
+	memcpy(copy, value.data, value.length);
+	copy[value.length] = '\0';
+	return copy;
+}
+
+bool Parser::convertValue(Option& opt, StringView argParam) {
+	// values are printed with a length, they may not be NUL-terminated
+	int length = (int)argParam.length;
+	const char* value = argParam.data;
+	if(opt.valueFromFile && length > 0 && value[0] == '@') {
+		if(length == 1 || value[1] != '@') {
+			return loadValueFile(opt, terminated(StringView {value+1, argParam.length-1}));
+		}
+		// @@ escapes a literal @
+		++argParam.data;
+		--argParam.length;
+		++value;
+		--length;
+	}
+	switch(opt.type) {
+		case Option::Type::Flag:
+		case Option::Type::FlagCount:
+			return true;
+		case Option::Type::Int: {
+			int64_t parsed = 0;
+			if(!parseInt64(argParam, parsed) || parsed < INT_MIN || parsed > INT_MAX) {
+				CLI_LOG_ERROR("error: invalid integer value \"%.*s\" specified for option -%c/--%s\n", length, value, opt.shortName, opt.longName);
+				return false;
+			}
+			opt.as<int>() = (int)parsed;
+			return true;
+		}
+		case Option::Type::Float: {
+			double parsed = 0;
+			if(!parseDouble(argParam, parsed)) {
+				CLI_LOG_ERROR("error: invalid float value \"%.*s\" specified for option -%c/--%s\n", length, value, opt.shortName, opt.longName);
+				return false;
+			}
+			opt.as<float>() = (float)parsed;
+			return true;
+		}
+		case Option::Type::Int64:
+			if(!parseInt64(argParam, opt.as<int64_t>())) {
+				if(opt.isPositional) {
+					CLI_LOG_ERROR("error: invalid integer value \"%.*s\" specified for argument <%s>\n", length, value, opt.longName);
+				} else {
+					CLI_LOG_ERROR("error: invalid integer value \"%.*s\" specified for option -%c/--%s\n", length, value, opt.shortName, opt.longName);
+				}
+				return false;
+			}
+			return true;
+		case Option::Type::Double:
+			if(!parseDouble(argParam, opt.as<double>())) {
+				if(opt.isPositional) {
+					CLI_LOG_ERROR("error: invalid float value \"%.*s\" specified for argument <%s>\n", length, value, opt.longName);
+				} else {
+					CLI_LOG_ERROR("error: invalid float value \"%.*s\" specified for option -%c/--%s\n", length, value, opt.shortName, opt.longName);
+				}
+				return false;
+			}
+			return true;
+		case Option::Type::Int64List:
+		case Option::Type::DoubleList:
+		case Option::Type::PathList:
+			return true;
+		case Option::Type::Decimal:
+			// a mistake in the spec, not in the value
+			if(opt.fractionalDigits < 0 || opt.fractionalDigits > 18) {
+				CLI_LOG_ERROR("error: option -%c/--%s is declared with %d fractional digits, 0 to 18 are supported\n", opt.shortName, opt.longName, opt.fractionalDigits);
+				return false;
+			}
+			switch(parseDecimal(argParam, opt.fractionalDigits, opt.as<int64_t>())) {
+				case DecimalResult::Ok:
+					return true;
+				case DecimalResult::Invalid:
+					CLI_LOG_ERROR("error: invalid decimal value \"%.*s\" specified for option -%c/--%s\n", length, value, opt.shortName, opt.longName);
+					return false;
+				case DecimalResult::OutOfRange:
+					CLI_LOG_ERROR("error: decimal value \"%.*s\" specified for option -%c/--%s is out of range\n", length, value, opt.shortName, opt.longName);
+					return false;
+				case DecimalResult::TooPrecise:
+					CLI_LOG_ERROR("error: decimal value \"%.*s\" specified for option -%c/--%s has more than %d fractional digits\n", length, value, opt.shortName, opt.longName, opt.fractionalDigits);
+					return false;
+			}
+			return false;
+		case Option::Type::Hex:
+		case Option::Type::Base64:
+			return decodeBlob(opt, argParam);
+		case Option::Type::SecretFd:
+			return readSecret(opt, argParam);
+		case Option::Type::Glob:
+		case Option::Type::Regex:
+			return compilePattern(opt, argParam);
+		case Option::Type::FilesFrom:
+			opt.as<FileList>().path = terminated(argParam);
+			return true;
+		case Option::Type::Shard:
+			return parseShard(opt, argParam);
+		case Option::Type::StringView:
+			opt.as<StringView>() = argParam;
+			return true;
+		case Option::Type::PathExisting:
+			if(!checkExistsReadable(terminated(argParam))) {
+				CLI_LOG_ERROR("error: invalid path \"%.*s\" specified for option -%c/--%s.  Path must point to an existing, readable file\n", length, value, opt.shortName, opt.longName);
+				return false;
+			}
+		case Option::Type::String:
+		case Option::Type::Path:
+			opt.as<const char*>() = terminated(argParam);
+			return true;
+	}
+	return true;
+}
+
+Token Parser::classifyToken(const char* arg, size_t length) {
+	if(length > 1 && arg[0] == '-') {
+		if(arg[1] != '-') {
+			return Token {Token::Kind::Short, arg+1, length-1, nullptr, 0};
+		}
+		const char* equals = (const char*)memchr(arg+2, '=', length-2);
+		if(equals != nullptr) {
+			return Token {Token::Kind::Long, arg+2, (size_t)(equals-(arg+2)), equals+1, (size_t)(arg+length-(equals+1))};
+		}
+		return Token {Token::Kind::Long, arg+2, length-2, nullptr, 0};
+	}
+	return Token {Token::Kind::Positional, arg, length, nullptr, 0};
+}
+
+// Parses a decimal string into an integer scaled by 10^fractionalDigits in a
+// single pass. Fails rather than rounding when the value can't be represented
+// exactly.  Trailing zeros beyond the declared precision are accepted.
+Parser::DecimalResult Parser::parseDecimal(StringView text, int fractionalDigits, int64_t& value) {
+	if(fractionalDigits < 0 || fractionalDigits > 18) {
+		return DecimalResult::Invalid;
+	}
+	const char* str = text.data;
+	const char* end = text.data + text.length;
+	bool negative = false;
+	if(str < end && (*str == '-' || *str == '+')) {
+		negative = *str == '-';
+		++str;
+	}
+	// magnitude of INT64_MIN
+	const uint64_t limit = negative ? (uint64_t)INT64_MAX + 1 : (uint64_t)INT64_MAX;
+	uint64_t magnitude = 0;
+	int digits = 0;
+	int fraction = -1;
+	bool droppedNonZero = false;
+	for(; str < end; ++str) {
+		if(*str == '.' && fraction < 0) {
+			fraction = 0;
+			continue;
+		}
+		unsigned digit = (unsigned)(*str - '0');
+		if(digit > 9) {
+			return DecimalResult::Invalid;
+		}
+		++digits;
+		if(fraction >= 0) {
+			if(fraction == fractionalDigits) {
+				droppedNonZero |= digit != 0;
+				continue;
+			}
+			++fraction;
+		}
+		if(magnitude > (limit - digit) / 10) {
+			return DecimalResult::OutOfRange;
+		}
+		magnitude = magnitude * 10 + digit;
+	}
+	if(digits == 0) {
+		return DecimalResult::Invalid;
+	}
+	if(droppedNonZero) {
+		return DecimalResult::TooPrecise;
+	}
+	for(int i = fraction < 0 ? 0 : fraction; i < fractionalDigits; ++i) {
+		if(magnitude > limit / 10) {
+			return DecimalResult::OutOfRange;
+		}
+		magnitude *= 10;
+	}
+	value = negative ? (int64_t)(0 - magnitude) : (int64_t)magnitude;
+	return DecimalResult::Ok;
+}
+
+bool Parser::decodeBlob(Option& opt, StringView text) {
+	Blob& blob = opt.as<Blob>();
+	const char* value = text.data;
+	size_t length = text.length;
+	bool hex = opt.type == Option::Type::Hex;
+	size_t decodedLength = hex ? decodedHexLength(value, length) : decodedBase64Length(value, length);
+	unsigned char* out = blob.buffer;
+	if(out == nullptr) {
+		out = allocate(decodedLength);
+	} else if(decodedLength > blob.capacity) {
+		CLI_LOG_ERROR("error: value specified for option -%c/--%s is too large, %zu bytes decoded but at most %zu are allowed\n", opt.shortName, opt.longName, decodedLength, blob.capacity);
+		return false;
+	}
+	size_t errorOffset = 0;
+	if(!(hex ? decodeHex(value, length, out, errorOffset) : decodeBase64(value, length, out, errorOffset))) {
+		if(errorOffset == length) {
+			CLI_LOG_ERROR("error: truncated %s value specified for option -%c/--%s\n", optionTypeDisplayName(opt.type), opt.shortName, opt.longName);
+		} else {
+			CLI_LOG_ERROR("error: invalid %s character '%c' at offset %zu specified for option -%c/--%s\n", optionTypeDisplayName(opt.type), value[errorOffset], errorOffset, opt.shortName, opt.longName);
+		}
+		return false;
+	}
+	blob.data = out;
+	blob.length = decodedLength;
+	return true;
+}
+
+bool Parser::loadValueFile(Option& opt, const char* path) {
+	MappedFile file;
+	if(!file.open(path)) {
+		CLI_LOG_ERROR("error: unable to read file \"%s\" specified for option -%c/--%s\n", path, opt.shortName, opt.longName);
+		return false;
+	}
+	switch(opt.type) {
+		case Option::Type::Hex:
+		case Option::Type::Base64: {
+			Blob& blob = opt.as<Blob>();
+			blob.data = (const unsigned char*)file.data;
+			blob.length = file.length;
+			break;
+		}
+		case Option::Type::String:
+			opt.as<const char*>() = file.data;
+			break;
+		default:
+			CLI_LOG_ERROR("error: option -%c/--%s can't be loaded from a file\n", opt.shortName, opt.longName);
+			return false;
+	}
+	mappedFiles.push_back(std::make_shared<MappedFile>(std::move(file)));
+	return true;
+}
+
+bool Parser::readSecret(Option& opt, StringView fdValue) {
+	int64_t fd = 0;
+	if(!parseInt64(fdValue, fd) || fdValue.data[0] == '-' || fd > INT_MAX) {
+		CLI_LOG_ERROR("error: invalid file descriptor \"%.*s\" specified for option -%c/--%s\n", (int)fdValue.length, fdValue.data, opt.shortName, opt.longName);
+		return false;
+	}
+#if defined(CLI_HAS_MMAP)
+	Secret& secret = opt.as<Secret>();
+	size_t capacity = secret.capacity > 0 ? secret.capacity : 4096;
+	LockedBuffer buffer;
+	// one extra byte to detect secrets that are too long and one for the NUL
+	if(!buffer.allocate(capacity + 2)) {
+		CLI_LOG_ERROR("error: unable to allocate locked memory for option -%c/--%s\n", opt.shortName, opt.longName);
+		return false;
+	}
+	ssize_t count;
+	do {
+		count = read((int)fd, buffer.data, capacity + 1);
+	} while(count < 0 && errno == EINTR);
+	if(count < 0) {
+		CLI_LOG_ERROR("error: unable to read file descriptor %d specified for option -%c/--%s\n", (int)fd, opt.shortName, opt.longName);
+		return false;
+	}
+	size_t length = (size_t)count;
+	if(length > 0 && buffer.data[length-1] == '\n') {
+		--length;
+		if(length > 0 && buffer.data[length-1] == '\r') {
+			--length;
+		}
+	}
+	if(length > capacity) {
+		CLI_LOG_ERROR("error: secret read for option -%c/--%s is longer than %zu bytes\n", opt.shortName, opt.longName, capacity);
+		return false;
+	}
+	buffer.data[length] = '\0';
+	secret.data = buffer.data;
+	secret.length = length;
+	lockedBuffers.push_back(std::make_shared<LockedBuffer>(std::move(buffer)));
+	return true;
+#else
+	CLI_LOG_ERROR("error: option -%c/--%s isn't supported on this platform\n", opt.shortName, opt.longName);
+	return false;
+#endif
+}
+
+#if defined(CLI_ENABLE_PATTERNS)
+bool Parser::compilePattern(Option& opt, StringView pattern) {
+	const char* error = nullptr;
+	size_t errorOffset = 0;
+	Pattern::Syntax syntax = opt.type == Option::Type::Glob ? Pattern::Syntax::Glob : Pattern::Syntax::Regex;
+	if(!opt.as<Pattern>().compile(pattern.data, pattern.length, syntax, error, errorOffset)) {
+		CLI_LOG_ERROR("error: invalid %s \"%.*s\" specified for option -%c/--%s: %s at offset %zu\n", optionTypeDisplayName(opt.type), (int)pattern.length, pattern.data, opt.shortName, opt.longName, error, errorOffset);
+		return false;
+	}
+	return true;
+}
+#else
+bool Parser::compilePattern(Option& opt, StringView) {
+	CLI_LOG_ERROR("error: option -%c/--%s needs CLI_ENABLE_PATTERNS\n", opt.shortName, opt.longName);
+	return false;
+}
+#endif
+
+unsigned char* Parser::allocate(size_t size) {
+	storage.emplace_back(size);
+	return storage.back().data();
+}
+
+bool Parser::parseInt64(StringView str, int64_t& value) {
+	// a decimal without fractional digits, minus the decimal point
+	return memchr(str.data, '.', str.length) == nullptr && parseDecimal(str, 0, value) == DecimalResult::Ok;
+}
+
+bool Parser::parseDouble(StringView str, double& value) {
+	// decimal notation only (no spaces, hex, inf or nan), with at least one digit
+	bool hasDigit = false;
+	for(size_t i = 0; i < str.length; ++i) {
+		char c = str.data[i];
+		if(c >= '0' && c <= '9') {
+			hasDigit = true;
+		} else if(c != '+' && c != '-' && c != '.' && c != 'e' && c != 'E') {
+			return false;
+		}
+	}
+	if(!hasDigit) {
+		return false;
+	}
+	// strtod needs a NUL-terminated copy, numbers are short
+	char number[64];
+	std::vector<char> longNumber;
+	char* copy = number;
+	if(str.length >= sizeof(number)) {
+		longNumber.resize(str.length + 1);
+		copy = longNumber.data();
+	}
+	memcpy(copy, str.data, str.length);
+	copy[str.length] = '\0';
+	// the whole string must be the number
+	char* end = nullptr;
+	value = strtod(copy, &end);
+	return end == copy + str.length;
+}
+
+bool Parser::handlePositional(StringView arg, int index) {
+	for(; nextPositional < positionalIndices.size(); ++nextPositional) {
+		Option& opt = options[positionalIndices[nextPositional]];
+		if(opt.isList()) {
+			// collected and converted at once after parsing
+			if(!opt.isSet) {
+				opt.isSet = true;
+				countUsage(opt);
+			}
+			listIndices.push_back(index);
+			return true;
+		}
+		if(!opt.isSet) {
+			opt.isSet = true;
+			countUsage(opt);
+			return convertValue(opt, arg);
+		}
+	}
+	remaining.push_back(terminated(arg));
+	return true;
+}
+
+// Converts the arguments collected by a Remaining option.  Large lists are
+// split into chunks converted in parallel.  Invalid arguments are reported in
+// order with their argv index.
+bool Parser::convertList(Option& opt) {
+	size_t count = listIndices.size();
+	size_t chunks = parallelChunkCount(count, 16384);
+	std::vector<std::vector<int>> invalid(chunks);
+
+	switch(opt.type) {
+		case Option::Type::Int64List: {
+			std::vector<int64_t>& values = opt.as<std::vector<int64_t>>();
+			values.resize(count);
+			parallelChunks(count, chunks, [&](size_t chunk, size_t begin, size_t end) {
+				for(size_t i = begin; i < end; ++i) {
+					if(!parseInt64(argumentView(listIndices[i]), values[i])) invalid[chunk].push_back(listIndices[i]);
+				}
+			});
+			break;
+		}
+		case Option::Type::DoubleList: {
+			std::vector<double>& values = opt.as<std::vector<double>>();
+			values.resize(count);
+			parallelChunks(count, chunks, [&](size_t chunk, size_t begin, size_t end) {
+				for(size_t i = begin; i < end; ++i) {
+					if(!parseDouble(argumentView(listIndices[i]), values[i])) invalid[chunk].push_back(listIndices[i]);
+				}
+			});
+			break;
+		}
+		case Option::Type::PathList: {
+			std::vector<const char*>& values = opt.as<std::vector<const char*>>();
+			values.resize(count);
+			for(size_t i = 0; i < count; ++i) {
+				values[i] = terminated(argumentView(listIndices[i]));
+			}
+			break;
+		}
+		default:
+			break;
+	}
+
+	bool valid = true;
+	for(std::vector<int>& chunkErrors : invalid) {
+		for(int index : chunkErrors) {
+			StringView argument = argumentView(index);
+			CLI_LOG_ERROR("error: invalid %s value \"%.*s\" at argument %d specified for <%s>\n", optionTypeDisplayName(opt.type), (int)argument.length, argument.data, index, opt.longName);
+			valid = false;
+		}
+	}
+	return valid;
+}
+
+int Parser::handleOption(int argc, const char** argv, int index) {
+	const Token& token = tokens[index];
+	switch(token.kind) {
+		case Token::Kind::Short:
+			if(passThroughMode != PassThrough::None) {
+				unsigned char shortName = (unsigned char)token.name[0];
+				bool known = shortOffsets[shortName + 1] > shortOffsets[shortName];
+				// the rest of the argument is forwarded with an unknown option
+				if(!known) {
+					passThrough(index);
+					return 0;
+				}
+			}
+			// Handle concatenated short options
+			for(size_t i = 0; i < token.nameLength; ++i) {
+				unsigned char shortName = (unsigned char)token.name[i];
+				for(uint32_t o = shortOffsets[shortName]; o < shortOffsets[shortName + 1]; ++o) {
+					bool consumedList = false;
+					int result = applyShortOption(options[shortIndices[o]], token, i, argc, argv, consumedList);
+					if(result != 0 || consumedList) return result;
+				}
+				if(shortOffsets[shortName + 1] == shortOffsets[shortName]) {
+					CLI_LOG_ERROR("error: unknown short option -%c\n", token.name[i]);
+					return -1;
+				}
+			}
+			return 0;
+		case Token::Kind::Long:
+			if(Option* opt = findLongOption(token.name, token.nameLength)) {
+				if(token.value != nullptr && !opt->takesValue()) {
+					CLI_LOG_ERROR("error: option --%s doesn't accept a value\n", opt->longName);
+					return -1;
+				}
+				return applyOption(*opt, StringView {token.value, token.valueLength}, argc, argv);
+			}
+			if(passThroughMode != PassThrough::None) {
+				passThrough(index);
+				return 0;
+			}
+			CLI_LOG_ERROR("error: unknown option --%.*s\n", (int)token.nameLength, token.name);
+			return -1;
+		case Token::Kind::Positional:
+			if(deferPositionals) {
+				deferredPositionals.push_back(index);
+				return 0;
+			}
+			if(passThroughMode == PassThrough::OptionsAndPositionals) {
+				passThrough(index);
+			}
+			return handlePositional(StringView {token.name, token.nameLength}, index) ? 0 : -1;
+	}
+	return 0;
+}
+
+// Applies the short option at position index of a short option list.
+// consumedList is set when the rest of the list is used as its value.
+int Parser::applyShortOption(Option& opt, const Token& token, size_t index, int argc, const char** argv, bool& consumedList) {
+	bool isLast = index == token.nameLength - 1;
+	// the rest of the list is the value of an optional-value option
+	if(opt.hasOptionalValue()) {
+		consumedList = true;
+		StringView attached = {isLast ? nullptr : token.name+index+1, token.nameLength-index-1};
+		int result = applyOption(opt, attached, argc, argv);
+		return result < 0 ? result : 0;
+	}
+	// arguments requiring parameters can't be in the middle of the list
+	if(opt.requiresParameter() && !isLast) {
+		CLI_LOG_ERROR("error: short option -%c cannot be used in the middle of a flag list, it requires a value\n", opt.shortName);
+		return -1;
+	}
+	return applyOption(opt, StringView {nullptr, 0}, argc, argv);
+}
+
+static int compareNames(const char* a, size_t aLength, const char* b, size_t bLength) {
+	int result = memcmp(a, b, aLength < bLength ? aLength : bLength);
+	if(result != 0) return result;
+	return aLength < bLength ? -1 : (aLength > bLength ? 1 : 0);
+}
+
+static bool optionNameLess(const OptionName& a, const OptionName& b) {
+	return compareNames(a.name, a.length, b.name, b.length) < 0;
+}
+
+void Parser::buildNameIndex() {
+	longNames.clear();
+	for(size_t i = 0; i < options.size(); ++i) {
+		if(!options[i].isPositional && options[i].longName != nullptr) {
+			longNames.push_back(OptionName {options[i].longName, strlen(options[i].longName), i});
+		}
+	}
+	std::stable_sort(longNames.begin(), longNames.end(), optionNameLess);
+
+	// short names are indexed with a counting sort, keeping declaration order
+	memset(shortOffsets, 0, sizeof(shortOffsets));
+	for(const Option& opt : options) {
+		if(opt.shortName != 0 && !opt.isPositional) ++shortOffsets[(unsigned char)opt.shortName + 1];
+	}
+	for(size_t c = 1; c < 257; ++c) {
+		shortOffsets[c] += shortOffsets[c - 1];
+	}
+	shortIndices.resize(shortOffsets[256]);
+	uint32_t next[256];
+	memcpy(next, shortOffsets, sizeof(next));
+	positionalIndices.clear();
+	finishIndices.clear();
+	hasLastWinsOption = false;
+	hasDefaultPolicyOption = false;
+	for(size_t i = 0; i < options.size(); ++i) {
+		const Option& opt = options[i];
+		if(opt.shortName != 0 && !opt.isPositional) shortIndices[next[(unsigned char)opt.shortName]++] = (uint32_t)i;
+		if(opt.isPositional) positionalIndices.push_back(i);
+		if(opt.isRequired || opt.isList() || opt.type == Option::Type::FilesFrom) finishIndices.push_back(i);
+		hasLastWinsOption |= opt.repeatPolicy == RepeatPolicy::LastWins;
+		hasDefaultPolicyOption |= opt.repeatPolicy == RepeatPolicy::Default;
+	}
+}
+
+Option* Parser::convertLazyOption(const char* longName) {
+	Option* opt = findLongOption(longName, strlen(longName));
+	if(opt == nullptr) {
+		return nullptr;
+	}
+	size_t index = (size_t)(opt - options.data());
+	auto state = lazyStates.find(index);
+	if(state == lazyStates.end()) {
+		// not given, or converted while parsing
+		return opt;
+	}
+	if(state->second == LazyState::Pending) {
+		bool valid = true;
+		if(repeatPolicyOf(*opt) == RepeatPolicy::Accumulate) {
+			for(const LazyValue& value : lazyValues) {
+				if(value.option == index) valid = valid && convertValue(*opt, value.value);
+			}
+		} else {
+			// the last recorded value is the one in effect
+			size_t last = lazyValues.size() - 1;
+			while(lazyValues[last].option != index) --last;
+			valid = convertValue(*opt, lazyValues[last].value);
+		}
+		state->second = valid ? LazyState::Converted : LazyState::Invalid;
+	}
+	return state->second == LazyState::Converted ? opt : nullptr;
+}
+
+Option* Parser::findLongOption(const char* name, size_t length) {
+	OptionName key = {name, length, 0};
+	auto found = std::lower_bound(longNames.begin(), longNames.end(), key, optionNameLess);
+	if(found == longNames.end() || compareNames(found->name, found->length, name, length) != 0) {
+		return nullptr;
+	}
+	return &options[found->option];
+}
+
+void Parser::passThrough(int index) {
+	if(!passThroughRanges.empty() && passThroughRanges.back().end == index) {
+		++passThroughRanges.back().end;
+	} else {
+		passThroughRanges.push_back(ArgumentRange {index, index + 1});
+	}
+	passThroughArgv.back() = terminated(argumentView(index));
+	passThroughArgv.push_back(nullptr);
+}
+
+const char* Parser::optionTypeDisplayName(Option::Type type) {
+	switch(type) {
+		case Option::Type::Flag:
+		case Option::Type::FlagCount:
+			return "flag";
+		case Option::Type::Int:
+		case Option::Type::Int64:
+		case Option::Type::Int64List:
+			return "integer";
+		case Option::Type::Float:
+		case Option::Type::Double:
+		case Option::Type::DoubleList:
+			return "float";
+		case Option::Type::Decimal:
+			return "decimal";
+		case Option::Type::Hex:
+			return "hex";
+		case Option::Type::Base64:
+			return "base64";
+		case Option::Type::SecretFd:
+			return "fd";
+		case Option::Type::Glob:
+			return "glob";
+		case Option::Type::Regex:
+			return "regex";
+		case Option::Type::Shard:
+			return "K/N";
+		case Option::Type::String:
+		case Option::Type::StringView:
+			return "string";
+		case Option::Type::Path:
+		case Option::Type::PathExisting:
+		case Option::Type::PathList:
+		case Option::Type::FilesFrom:
+			return "path";
+		default:
+			return "unknown";
+	}
+}
+
+bool Parser::parseShard(Option& opt, StringView value) {
+	int64_t index = 0;
+	int64_t count = 0;
+	const char* slash = (const char*)memchr(value.data, '/', value.length);
+	size_t indexLength = slash != nullptr ? (size_t)(slash - value.data) : 0;
+	if(slash == nullptr || indexLength == 0 || !parseInt64(StringView {slash + 1, value.length - indexLength - 1}, count) || count < 1 || count > INT32_MAX) {
+		CLI_LOG_ERROR("error: invalid shard \"%.*s\" specified for option -%c/--%s, expected K/N\n", (int)value.length, value.data, opt.shortName, opt.longName);
+		return false;
+	}
+	if(!parseInt64(StringView {value.data, indexLength}, index) || index < 1 || index > count) {
+		CLI_LOG_ERROR("error: invalid shard \"%.*s\" specified for option -%c/--%s, K must be between 1 and N\n", (int)value.length, value.data, opt.shortName, opt.longName);
+		return false;
+	}
+	FileList& list = opt.as<FileList>();
+	list.shardIndex = (size_t)(index - 1);
+	list.shardCount = (size_t)count;
+	return true;
+}
+
+bool Parser::checkExistsReadable(const char* path) {
+	FILE* f = fopen(path, "rb");
+	if(f != NULL) {
+		fclose(f);
+		return true;
+	} else {
+		return false;
+	}
+}
+
+// Binary decoders.  On x86 the bulk of the input is decoded 16 characters at a
+// time with SSSE3 when the CPU supports it.  Blocks containing an invalid
+// character are handed to the scalar decoder, which finds its exact offset.
+
+static int hexValue(char c) {
+	if(c >= '0' && c <= '9') return c - '0';
+	if(c >= 'a' && c <= 'f') return c - 'a' + 10;
+	if(c >= 'A' && c <= 'F') return c - 'A' + 10;
+	return -1;
+}
+
+static int base64Value(char c) {
+	if(c >= 'A' && c <= 'Z') return c - 'A';
+	if(c >= 'a' && c <= 'z') return c - 'a' + 26;
+	if(c >= '0' && c <= '9') return c - '0' + 52;
+	if(c == '+') return 62;
+	if(c == '/') return 63;
+	return -1;
+}
+
+#if defined(CLI_SIMD_SSSE3)
+static bool cpuHasSSSE3() {
+	static const bool supported = __builtin_cpu_supports("ssse3");
+	return supported;
+}
+
+// Decodes 32 hex digits into 16 bytes, false if any digit is invalid
+__attribute__((target("ssse3")))
+static bool decodeHexBlock(const char* in, unsigned char* out) {
+	const __m128i nine = _mm_set1_epi8(9);
+	const __m128i five = _mm_set1_epi8(5);
+	const __m128i weights = _mm_set1_epi16(0x0110);
+	__m128i nibbles[2];
+	for(int half = 0; half < 2; ++half) {
+		__m128i chars = _mm_loadu_si128((const __m128i*)(in + half*16));
+		__m128i digits = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+		__m128i isDigit = _mm_cmpeq_epi8(_mm_min_epu8(digits, nine), digits);
+		__m128i letters = _mm_sub_epi8(_mm_or_si128(chars, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+		__m128i isLetter = _mm_cmpeq_epi8(_mm_min_epu8(letters, five), letters);
+		if(_mm_movemask_epi8(_mm_or_si128(isDigit, isLetter)) != 0xFFFF) {
+			return false;
+		}
+		nibbles[half] = _mm_or_si128(_mm_and_si128(isDigit, digits),
+			_mm_and_si128(isLetter, _mm_add_epi8(letters, _mm_set1_epi8(10))));
+	}
+	// (high, low) nibble pairs to bytes
+	__m128i lo = _mm_maddubs_epi16(nibbles[0], weights);
+	__m128i hi = _mm_maddubs_epi16(nibbles[1], weights);
+	_mm_storeu_si128((__m128i*)out, _mm_packus_epi16(lo, hi));
+	return true;
+}
+
+// Decodes 16 base64 characters into 12 bytes, false if any character is invalid
+__attribute__((target("ssse3")))
+static bool decodeBase64Block(const char* in, unsigned char* out) {
+	const __m128i lutLo = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+	const __m128i lutHi = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+	const __m128i lutRoll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+	const __m128i mask = _mm_set1_epi8(0x2F);
+
+	__m128i chars = _mm_loadu_si128((const __m128i*)in);
+	__m128i hiNibbles = _mm_and_si128(_mm_srli_epi32(chars, 4), mask);
+	__m128i loNibbles = _mm_and_si128(chars, mask);
+	__m128i hi = _mm_shuffle_epi8(lutHi, hiNibbles);
+	__m128i lo = _mm_shuffle_epi8(lutLo, loNibbles);
+	// each class bit set in both tables marks an invalid character
+	if(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(lo, hi), _mm_setzero_si128())) != 0xFFFF) {
+		return false;
+	}
+	__m128i isSlash = _mm_cmpeq_epi8(chars, mask);
+	__m128i roll = _mm_shuffle_epi8(lutRoll, _mm_add_epi8(isSlash, hiNibbles));
+	__m128i sextets = _mm_add_epi8(chars, roll);
+
+	// pack four 6 bit values into 3 bytes
+	__m128i merged = _mm_maddubs_epi16(sextets, _mm_set1_epi32(0x01400140));
+	__m128i packed = _mm_madd_epi16(merged, _mm_set1_epi32(0x00011000));
+	packed = _mm_shuffle_epi8(packed, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+	unsigned char block[16];
+	_mm_storeu_si128((__m128i*)block, packed);
+	memcpy(out, block, 12);
+	return true;
+}
+#endif
+
+// in is only taken for symmetry with decodedBase64Length()
+size_t decodedHexLength(const char*, size_t length) {
+	return length / 2;
+}
+
+bool decodeHex(const char* in, size_t length, unsigned char* out, size_t& errorOffset) {
+	size_t i = 0;
+#if defined(CLI_SIMD_SSSE3)
+	if(cpuHasSSSE3()) {
+		for(; i + 32 <= length && decodeHexBlock(in + i, out + i/2); i += 32) {}
+	}
+#endif
+	for(; i + 1 < length; i += 2) {
+		int hi = hexValue(in[i]);
+		int lo = hexValue(in[i+1]);
+		if(hi < 0 || lo < 0) {
+			errorOffset = hi < 0 ? i : i + 1;
+			return false;
+		}
+		out[i/2] = (unsigned char)(hi << 4 | lo);
+	}
+	if(i < length) {
+		errorOffset = hexValue(in[i]) < 0 ? i : length;
+		return false;
+	}
+	return true;
+}
+
+// Length of base64 input without its padding
+static size_t base64DataLength(const char* in, size_t length) {
+	if(length % 4 == 0) {
+		for(int pad = 0; pad < 2 && length > 0 && in[length-1] == '='; ++pad) {
+			--length;
+		}
+	}
+	return length;
+}
+
+size_t decodedBase64Length(const char* in, size_t length) {
+	size_t dataLength = base64DataLength(in, length);
+	size_t tail = dataLength % 4;
+	return dataLength / 4 * 3 + (tail > 1 ? tail - 1 : 0);
+}
+
+bool decodeBase64(const char* in, size_t length, unsigned char* out, size_t& errorOffset) {
+	size_t dataLength = base64DataLength(in, length);
+	size_t i = 0;
+#if defined(CLI_SIMD_SSSE3)
+	if(cpuHasSSSE3()) {
+		for(; i + 16 <= dataLength && decodeBase64Block(in + i, out + i/4*3); i += 16) {}
+	}
+#endif
+	for(; i < dataLength; i += 4) {
+		uint32_t bits = 0;
+		size_t count = dataLength - i < 4 ? dataLength - i : 4;
+		for(size_t j = 0; j < count; ++j) {
+			int value = base64Value(in[i+j]);
+			if(value < 0) {
+				errorOffset = i + j;
+				return false;
+			}
+			bits |= (uint32_t)value << (18 - 6*j);
+		}
+		if(count == 1) {
+			errorOffset = length;
+			return false;
+		}
+		unsigned char* o = out + i/4*3;
+		o[0] = (unsigned char)(bits >> 16);
+		if(count > 2) o[1] = (unsigned char)(bits >> 8);
+		if(count > 3) o[2] = (unsigned char)bits;
+	}
+	return true;
+}
+
+
+#if defined(CLI_ENABLE_PATTERNS)
+// Pattern compilation.  The pattern is parsed into a Glushkov automaton, where
+// every character (set) of the pattern is a position of the NFA, tracked in a
+// fixed size bit set.  The NFA is then turned into a DFA over classes of bytes
+// that behave identically.
+class PatternCompiler {
+public:
+	// The last bit is the start state of the NFA, the other bits are positions
+	enum {
+		PositionWords = 16,
+		MaxPositions = PositionWords * 64 - 1,
+		StartPosition = MaxPositions,
+		MaxStates = 4096
+	};
+
+	struct PositionSet {
+		uint64_t words[PositionWords];
+
+		void add(size_t p) { words[p >> 6] |= 1ull << (p & 63); }
+		bool intersects(const PositionSet& other) const {
+			for(size_t i = 0; i < PositionWords; ++i) if(words[i] & other.words[i]) return true;
+			return false;
+		}
+		PositionSet operator&(const PositionSet& other) const {
+			PositionSet result;
+			for(size_t i = 0; i < PositionWords; ++i) result.words[i] = words[i] & other.words[i];
+			return result;
+		}
+		PositionSet operator|(const PositionSet& other) const {
+			PositionSet result;
+			for(size_t i = 0; i < PositionWords; ++i) result.words[i] = words[i] | other.words[i];
+			return result;
+		}
+		PositionSet& operator|=(const PositionSet& other) {
+			for(size_t i = 0; i < PositionWords; ++i) words[i] |= other.words[i];
+			return *this;
+		}
+		bool operator==(const PositionSet& other) const {
+			return memcmp(words, other.words, sizeof(words)) == 0;
+		}
+		bool operator!=(const PositionSet& other) const {
+			return !(*this == other);
+		}
+		// Calls f with each position in the set
+		template<typename F>
+		void forEach(F f) const {
+			for(size_t i = 0; i < PositionWords; ++i) {
+				size_t p = i * 64;
+				for(uint64_t bits = words[i]; bits != 0; bits >>= 1, ++p) {
+					if(bits & 1) f(p);
+				}
+			}
+		}
+	};
+
+	struct PositionSetHash {
+		size_t operator()(const PositionSet& set) const {
+			uint64_t hash = 14695981039346656037ull;
+			for(uint64_t w : set.words) hash = (hash ^ w) * 1099511628211ull;
+			return (size_t)hash;
+		}
+	};
+
+	struct ByteSet {
+		uint64_t bits[4];
+
+		void add(unsigned char c) { bits[c >> 6] |= 1ull << (c & 63); }
+		bool contains(unsigned char c) const { return (bits[c >> 6] >> (c & 63)) & 1; }
+		void addRange(unsigned char from, unsigned char to) {
+			for(unsigned c = from; c <= to; ++c) add((unsigned char)c);
+		}
+		void invert() { for(uint64_t& b : bits) b = ~b; }
+	};
+
+	// Sub-expression of the pattern
+	struct Fragment {
+		bool nullable;
+		PositionSet first;
+		PositionSet last;
+	};
+
+	PatternCompiler(const char* pattern, size_t length, Pattern::Syntax syntax)
+		: pattern(pattern), length(length), offset(0), syntax(syntax), error(nullptr), follow(MaxPositions + 1), depth(0) {
+	}
+
+	bool build(Fragment& result) {
+		if(syntax == Pattern::Syntax::Regex) {
+			// each top-level alternative has its own anchors, as in POSIX and PCRE
+			if(!parseBranch(result)) return false;
+			while(offset < length && pattern[offset] == '|') {
+				++offset;
+				Fragment next;
+				if(!parseBranch(next)) return false;
+				result = alternative(result, next);
+			}
+		} else if(!parseAlternation(result, length)) {
+			return false;
+		}
+		if(offset != length) {
+			return fail(pattern[offset] == ')' ? "unbalanced )" : "unexpected character");
+		}
+		return error == nullptr;
+	}
+
+	const char* pattern;
+	size_t length;
+	size_t offset;
+	Pattern::Syntax syntax;
+	const char* error;
+	std::vector<ByteSet> positions;
+	// positions that can follow each position, by position
+	std::vector<PositionSet> follow;
+
+private:
+	int depth;	// nesting of glob braces or regex groups
+
+	bool fail(const char* message) {
+		if(error == nullptr) error = message;
+		return false;
+	}
+
+	bool isQuantifier(char c) {
+		return c == '*' || c == '+' || c == '?';
+	}
+
+	static Fragment empty() {
+		Fragment result = {};
+		result.nullable = true;
+		return result;
+	}
+
+	Fragment position(const ByteSet& set) {
+		Fragment result = {};
+		if(positions.size() >= MaxPositions) {
+			fail("pattern too long");
+			return result;
+		}
+		positions.push_back(set);
+		result.first.add(positions.size() - 1);
+		result.last = result.first;
+		return result;
+	}
+
+	Fragment anyStar() {
+		ByteSet any;
+		memset(&any, 0xFF, sizeof(any));
+		return star(position(any));
+	}
+
+	void link(const PositionSet& from, const PositionSet& to) {
+		from.forEach([&](size_t p) { follow[p] |= to; });
+	}
+
+	Fragment concat(const Fragment& a, const Fragment& b) {
+		link(a.last, b.first);
+		return Fragment {
+			a.nullable && b.nullable,
+			a.nullable ? a.first | b.first : a.first,
+			b.nullable ? b.last | a.last : b.last
+		};
+	}
+
+	Fragment star(const Fragment& a) {
+		link(a.last, a.first);
+		return Fragment {true, a.first, a.last};
+	}
+
+	Fragment alternative(const Fragment& a, const Fragment& b) {
+		return Fragment {a.nullable || b.nullable, a.first | b.first, a.last | b.last};
+	}
+
+	// Top-level alternative of a regex, matched anywhere in the text unless
+	// anchored with ^ or $
+	bool parseBranch(Fragment& result) {
+		bool anchoredStart = offset < length && pattern[offset] == '^';
+		if(anchoredStart) ++offset;
+		Fragment sequence;
+		if(!parseSequence(sequence, length)) return false;
+		bool anchoredEnd = offset < length && pattern[offset] == '$';
+		if(anchoredEnd) ++offset;
+		result = anchoredStart ? empty() : anyStar();
+		result = concat(result, sequence);
+		if(!anchoredEnd) result = concat(result, anyStar());
+		return error == nullptr;
+	}
+
+	bool parseAlternation(Fragment& result, size_t end) {
+		char separator = syntax == Pattern::Syntax::Glob ? ',' : '|';
+		if(!parseSequence(result, end)) return false;
+		// commas are only alternatives inside glob braces
+		while(offset < end && pattern[offset] == separator && (syntax == Pattern::Syntax::Regex || depth > 0)) {
+			++offset;
+			Fragment next;
+			if(!parseSequence(next, end)) return false;
+			result = alternative(result, next);
+		}
+		return true;
+	}
+
+	bool parseSequence(Fragment& result, size_t end) {
+		result = empty();
+		while(offset < end && !error) {
+			char c = pattern[offset];
+			if(syntax == Pattern::Syntax::Regex && (c == '|' || c == ')')) break;
+			// the end anchor of a top-level alternative
+			if(syntax == Pattern::Syntax::Regex && c == '$' && depth == 0 && (offset + 1 == end || pattern[offset+1] == '|')) break;
+			if(syntax == Pattern::Syntax::Glob && depth > 0 && (c == ',' || c == '}')) break;
+			Fragment atom;
+			if(!parseAtom(atom, end)) return false;
+			if(syntax == Pattern::Syntax::Regex) {
+				if(offset < end && isQuantifier(pattern[offset])) {
+					char quantifier = pattern[offset++];
+					if(quantifier == '*') {
+						atom = star(atom);
+					} else if(quantifier == '+') {
+						link(atom.last, atom.first);
+					} else {
+						atom.nullable = true;
+					}
+					// lazy quantifiers match the same texts
+					if(offset < end && pattern[offset] == '?') ++offset;
+					if(offset < end && isQuantifier(pattern[offset])) return fail("nested quantifier");
+				}
+			}
+			result = concat(result, atom);
+		}
+		return error == nullptr;
+	}
+
+	bool parseAtom(Fragment& result, size_t end) {
+		char c = pattern[offset];
+		ByteSet set = {};
+		if(syntax == Pattern::Syntax::Glob) {
+			switch(c) {
+				case '*': {
+					++offset;
+					result = anyStar();
+					return error == nullptr;
+				}
+				case '?':
+					++offset;
+					memset(&set, 0xFF, sizeof(set));
+					result = position(set);
+					return error == nullptr;
+				case '[':
+					if(!parseSet(set, end, '!')) return false;
+					result = position(set);
+					return error == nullptr;
+				case '{': {
+					size_t start = offset++;
+					++depth;
+					if(!parseAlternation(result, end)) return false;
+					--depth;
+					if(offset >= end || pattern[offset] != '}') {
+						offset = start;
+						return fail("unterminated {");
+					}
+					++offset;
+					return true;
+				}
+				case '}':
+					return fail("unbalanced }");
+			}
+		} else {
+			switch(c) {
+				case '.':
+					++offset;
+					memset(&set, 0xFF, sizeof(set));
+					result = position(set);
+					return error == nullptr;
+				case '[':
+					if(!parseSet(set, end, '^')) return false;
+					result = position(set);
+					return error == nullptr;
+				case '(': {
+					size_t start = offset++;
+					++depth;
+					if(!parseAlternation(result, end)) return false;
+					--depth;
+					if(offset >= end || pattern[offset] != ')') {
+						offset = start;
+						return fail("unbalanced (");
+					}
+					++offset;
+					return true;
+				}
+				case '*':
+				case '+':
+				case '?':
+					return fail("quantifier without an expression");
+				case '{':
+				case '}':
+					return fail("repetition counts aren't supported");
+				case '^':
+				case '$':
+					return fail("anchors are only supported at the ends of top-level alternatives");
+			}
+		}
+		if(c == '\\') {
+			if(!parseEscape(set, end)) return false;
+		} else {
+			set.add((unsigned char)c);
+			++offset;
+		}
+		result = position(set);
+		return error == nullptr;
+	}
+
+	bool parseEscape(ByteSet& set, size_t end) {
+		if(offset + 1 >= end) return fail("trailing \\");
+		char c = pattern[offset + 1];
+		offset += 2;
+		if(syntax == Pattern::Syntax::Regex) {
+			switch(c) {
+				case 'd':
+					set.addRange('0', '9');
+					return true;
+				case 'w':
+					set.addRange('0', '9');
+					set.addRange('a', 'z');
+					set.addRange('A', 'Z');
+					set.add('_');
+					return true;
+				case 's':
+					set.add(' ');
+					set.addRange('\t', '\r');
+					return true;
+			}
+		}
+		set.add((unsigned char)c);
+		return true;
+	}
+
+	bool parseSet(ByteSet& set, size_t end, char negation) {
+		size_t start = offset++;
+		bool negated = offset < end && pattern[offset] == negation;
+		if(negated) ++offset;
+		bool first = true;
+		while(offset < end && (pattern[offset] != ']' || first)) {
+			first = false;
+			unsigned char from = (unsigned char)pattern[offset];
+			if(from == '\\' && offset + 1 < end) from = (unsigned char)pattern[++offset];
+			++offset;
+			unsigned char to = from;
+			if(offset + 1 < end && pattern[offset] == '-' && pattern[offset+1] != ']') {
+				to = (unsigned char)pattern[offset+1];
+				if(to == '\\' && offset + 2 < end) to = (unsigned char)pattern[++offset + 1];
+				offset += 2;
+				if(to < from) {
+					offset = start;
+					return fail("invalid range");
+				}
+			}
+			set.addRange(from, to);
+		}
+		if(offset >= end) {
+			offset = start;
+			return fail("unterminated [");
+		}
+		++offset;
+		if(negated) set.invert();
+		return true;
+	}
+};
+
+bool Pattern::compile(const char* pattern, size_t length, Syntax syntax, const char*& error, size_t& errorOffset) {
+	classCount = 0;
+	transitions.clear();
+	accepting.clear();
+
+	PatternCompiler compiler(pattern, length, syntax);
+	PatternCompiler::Fragment expr;
+	if(!compiler.build(expr)) {
+		error = compiler.error;
+		errorOffset = compiler.offset;
+		return false;
+	}
+	typedef PatternCompiler::PositionSet PositionSet;
+	PositionSet start = {};
+	start.add(PatternCompiler::StartPosition);
+	compiler.follow[PatternCompiler::StartPosition] = expr.first;
+	PositionSet accept = expr.nullable ? expr.last | start : expr.last;
+
+	// Bytes accepted by the same positions share a class
+	std::vector<PositionSet> classMasks;
+	for(unsigned c = 0; c < 256; ++c) {
+		PositionSet mask = {};
+		for(size_t p = 0; p < compiler.positions.size(); ++p) {
+			if(compiler.positions[p].contains((unsigned char)c)) mask.add(p);
+		}
+		size_t k = 0;
+		while(k < classMasks.size() && classMasks[k] != mask) ++k;
+		if(k == classMasks.size()) classMasks.push_back(mask);
+		byteClasses[c] = (unsigned char)k;
+	}
+
+	// Subset construction, state 0 is the empty set
+	std::vector<PositionSet> states = { PositionSet(), start };
+	std::unordered_map<PositionSet, uint16_t, PatternCompiler::PositionSetHash> stateIds = { {states[0], 0}, {start, 1} };
+	std::vector<uint16_t> table(2 * classMasks.size(), 0);
+	for(size_t s = 1; s < states.size(); ++s) {
+		PositionSet reachable = {};
+		states[s].forEach([&](size_t p) { reachable |= compiler.follow[p]; });
+		for(size_t k = 0; k < classMasks.size(); ++k) {
+			PositionSet next = reachable & classMasks[k];
+			auto found = stateIds.find(next);
+			if(found == stateIds.end()) {
+				if(states.size() >= PatternCompiler::MaxStates) {
+					error = "pattern too complex";
+					errorOffset = 0;
+					return false;
+				}
+				found = stateIds.emplace(next, (uint16_t)states.size()).first;
+				states.push_back(next);
+				table.resize(states.size() * classMasks.size(), 0);
+			}
+			table[s * classMasks.size() + k] = found->second;
+		}
+	}
+
+	accepting.resize(states.size());
+	for(size_t s = 0; s < states.size(); ++s) {
+		accepting[s] = states[s].intersects(accept);
+	}
+	transitions.swap(table);
+	classCount = (uint32_t)classMasks.size();
+	return true;
+}
+#endif
+
+#if defined(CLI_ENABLE_SWEEPS)
+void Sweep::clear() {
+	axes.clear();
+	strings.clear();
+	itemOffsets.clear();
+}
+
+size_t Sweep::size() const {
+	// addAxis() keeps the product within size_t
+	size_t total = 1;
+	for(const Axis& axis : axes) {
+		total *= axis.count;
+	}
+	return total;
+}
+
+bool Sweep::select(size_t variant) {
+	if(variant >= size()) {
+		return false;
+	}
+	for(size_t i = axes.size(); i-- > 0;) {
+		Axis& axis = axes[i];
+		if(!applyItem(axis, variant % axis.count)) {
+			return false;
+		}
+		variant /= axis.count;
+	}
+	return true;
+}
+
+bool Sweep::applyItem(Axis& axis, size_t index) {
+	Option& opt = parser->options[axis.option];
+	if(!axis.isRange) {
+		return parser->convertValue(opt, item(axis.firstItem + index));
+	}
+	int64_t value = axis.first + (int64_t)index * axis.step;
+	switch(opt.type) {
+		case Option::Type::Int64:
+			opt.as<int64_t>() = value;
+			return true;
+		case Option::Type::Int:
+			opt.as<int>() = (int)value;
+			return true;
+		default:
+			snprintf(axis.formatted, sizeof(axis.formatted), "%lld", (long long)value);
+			return parser->convertValue(opt, axis.formatted);
+	}
+}
+
+bool Sweep::addAxis(Option& opt, const char* value) {
+	bool numeric = false;
+	switch(opt.type) {
+		case Option::Type::Int:
+		case Option::Type::Int64:
+		case Option::Type::Float:
+		case Option::Type::Double:
+		case Option::Type::Decimal:
+			numeric = true;
+			break;
+		case Option::Type::String:
+		case Option::Type::Path:
+			break;
+		default:
+			return parser->convertValue(opt, value);
+	}
+
+	size_t length = strlen(value);
+	bool braced = length >= 2 && value[0] == '{' && value[length-1] == '}';
+	if(braced) {
+		++value;
+		length -= 2;
+	} else if(!numeric || strchr(value, ',') == nullptr) {
+		return parser->convertValue(opt, value);
+	}
+
+	Axis axis = {};
+	axis.option = (size_t)(&opt - parser->options.data());
+	const char* dots = strstr(value, "..");
+	if(braced && dots != nullptr && dots < value + length) {
+		if(!addRange(axis, opt, value, length)) {
+			return false;
+		}
+	} else {
+		axis.firstItem = itemOffsets.size();
+		const char* end = value + length;
+		for(const char* itemStart = value; itemStart <= end;) {
+			const char* itemEnd = (const char*)memchr(itemStart, ',', (size_t)(end - itemStart));
+			if(itemEnd == nullptr) itemEnd = end;
+			if(itemEnd == itemStart) {
+				CLI_LOG_ERROR("error: empty value in list \"%.*s\" specified for option -%c/--%s\n", (int)length, value, opt.shortName, opt.longName);
+				return false;
+			}
+			itemOffsets.push_back(strings.size());
+			strings.insert(strings.end(), itemStart, itemEnd);
+			strings.push_back('\0');
+			itemStart = itemEnd + 1;
+		}
+		axis.count = itemOffsets.size() - axis.firstItem;
+		// validate every listed value once
+		for(size_t i = 0; i < axis.count; ++i) {
+			if(!parser->convertValue(opt, item(axis.firstItem + i))) {
+				return false;
+			}
+		}
+	}
+	if(size() > SIZE_MAX / axis.count) {
+		CLI_LOG_ERROR("error: too many variants with the values \"%.*s\" specified for option -%c/--%s\n", (int)length, value, opt.shortName, opt.longName);
+		return false;
+	}
+	axes.push_back(axis);
+	return applyItem(axes.back(), 0);
+}
+
+bool Sweep::addRange(Axis& axis, Option& opt, const char* value, size_t length) {
+	// first..last or first..last..step
+	int64_t bounds[3] = {0, 0, 1};
+	int boundCount = 0;
+	bool valid = true;
+	const char* end = value + length;
+	for(const char* cursor = value; valid; cursor += 2) {
+		const char* boundEnd = cursor;
+		while(boundEnd < end && !(boundEnd[0] == '.' && boundEnd + 1 < end && boundEnd[1] == '.')) ++boundEnd;
+		char number[24];
+		size_t numberLength = (size_t)(boundEnd - cursor);
+		valid = boundCount < 3 && numberLength > 0 && numberLength < sizeof(number);
+		if(valid) {
+			memcpy(number, cursor, numberLength);
+			number[numberLength] = '\0';
+			valid = parser->parseInt64(number, bounds[boundCount++]);
+		}
+		if(boundEnd == end) break;
+		cursor = boundEnd;
+	}
+	int64_t first = bounds[0], last = bounds[1], step = bounds[2];
+	// the step must go from first towards last, distances are unsigned so they can't overflow
+	bool ascending = last >= first;
+	uint64_t distance = ascending ? (uint64_t)last - (uint64_t)first : (uint64_t)first - (uint64_t)last;
+	uint64_t stride = step > 0 ? (uint64_t)step : 0 - (uint64_t)step;
+	if(!valid || boundCount < 2 || step == 0 || (last != first && (step > 0) != ascending) || distance / stride >= SIZE_MAX) {
+		CLI_LOG_ERROR("error: invalid range \"{%.*s}\" specified for option -%c/--%s\n", (int)length, value, opt.shortName, opt.longName);
+		return false;
+	}
+	// every value lies between first and last
+	if(opt.type == Option::Type::Int && (first < INT_MIN || first > INT_MAX || last < INT_MIN || last > INT_MAX)) {
+		CLI_LOG_ERROR("error: range \"{%.*s}\" specified for option -%c/--%s is out of range\n", (int)length, value, opt.shortName, opt.longName);
+		return false;
+	}
+	axis.isRange = true;
+	axis.first = first;
+	axis.step = step;
+	axis.count = (size_t)(distance / stride) + 1;
+	return true;
+}
+#endif
+
+#if defined(CLI_ENABLE_COMPOSITE)
+CompositeParser::CompositeParser(std::initializer_list<Parser*> parserList) : parsers(parserList), conflicts(false) {
+	memset(shortNames, 0, sizeof(shortNames));
+	if(parsers.size() > 255) {
+		CLI_LOG_ERROR("error: a composite parser can't have more than 255 parsers\n");
+		conflicts = true;
+		parsers.resize(255);
+	}
+	for(size_t p = 0; p < parsers.size(); ++p) {
+		// each parser's index is already sorted, merge it in
+		size_t merged = longNames.size();
+		for(const OptionName& name : parsers[p]->longNames) {
+			longNames.push_back(Route {name, p});
+		}
+		std::inplace_merge(longNames.begin(), longNames.begin() + merged, longNames.end(), [](const Route& a, const Route& b) {
+			return optionNameLess(a.name, b.name);
+		});
+
+		for(const Option& opt : parsers[p]->options) {
+			unsigned char shortName = (unsigned char)opt.shortName;
+			if(shortName == 0 || opt.isPositional) continue;
+			if(shortNames[shortName] != 0 && shortNames[shortName] != p + 1) {
+				CLI_LOG_ERROR("error: option -%c is defined by more than one parser\n", opt.shortName);
+				conflicts = true;
+			}
+			shortNames[shortName] = (unsigned char)(p + 1);
+		}
+	}
+	for(size_t i = 1; i < longNames.size(); ++i) {
+		const Route& previous = longNames[i-1];
+		const Route& route = longNames[i];
+		if(route.parser != previous.parser && compareNames(route.name.name, route.name.length, previous.name.name, previous.name.length) == 0) {
+			CLI_LOG_ERROR("error: option --%s is defined by more than one parser\n", route.name.name);
+			conflicts = true;
+		}
+	}
+}
+
+bool CompositeParser::parse(int argc, const char* argv[]) {
+	if(conflicts || parsers.empty()) {
+		return false;
+	}
+	for(Parser* parser : parsers) {
+		parser->beginParse(argc, argv);
+	}
+	for(int i = 1; i < argc; ++i) {
+		int result = handleOption(argc-i, argv+i, i);
+		if(result < 0) return false;
+		i += result;
+	}
+	bool valid = true;
+	for(Parser* parser : parsers) {
+		valid = parser->finishParse() && valid;
+	}
+	return valid;
+}
+
+int CompositeParser::handleOption(int argc, const char** argv, int index) {
+	Token token = parsers.back()->classifyToken(argv[0]);
+	switch(token.kind) {
+		case Token::Kind::Short:
+			for(size_t i = 0; i < token.nameLength; ++i) {
+				unsigned char owner = shortNames[(unsigned char)token.name[i]];
+				if(owner == 0) {
+					CLI_LOG_ERROR("error: unknown short option -%c\n", token.name[i]);
+					return -1;
+				}
+				Parser* parser = parsers[owner - 1];
+				for(Option& opt : parser->options) {
+					if(opt.shortName == token.name[i]) {
+						bool consumedList = false;
+						int result = parser->applyShortOption(opt, token, i, argc, argv, consumedList);
+						if(result != 0 || consumedList) return result;
+					}
+				}
+			}
+			return 0;
+		case Token::Kind::Long: {
+			Route key = {OptionName {token.name, token.nameLength, 0}, 0};
+			auto found = std::lower_bound(longNames.begin(), longNames.end(), key, [](const Route& a, const Route& b) {
+				return optionNameLess(a.name, b.name);
+			});
+			if(found == longNames.end() || compareNames(found->name.name, found->name.length, token.name, token.nameLength) != 0) {
+				CLI_LOG_ERROR("error: unknown option %s\n", argv[0]);
+				return -1;
+			}
+			Parser* parser = parsers[found->parser];
+			Option& opt = parser->options[found->name.option];
+			if(token.value != nullptr && !opt.takesValue()) {
+				CLI_LOG_ERROR("error: option --%s doesn't accept a value\n", opt.longName);
+				return -1;
+			}
+			return parser->applyOption(opt, StringView {token.value, token.valueLength}, argc, argv);
+		}
+		case Token::Kind::Positional:
+			return parsers.back()->handlePositional(StringView {token.name, token.nameLength}, index) ? 0 : -1;
+	}
+	return 0;
+}
+#endif
+
+// FNV-1a hash used to assign lines to shards
+static uint64_t lineHash(const char* data, size_t length) {
+	uint64_t hash = 14695981039346656037ull;
+	for(size_t i = 0; i < length; ++i) {
+		hash = (hash ^ (unsigned char)data[i]) * 1099511628211ull;
+	}
+	return hash;
+}
+
+// Calls fn(line, length) for each non-empty line starting in [begin, end) and
+// returns the number of lines
+template<typename F>
+static size_t forEachLine(const char* data, size_t length, size_t begin, size_t end, F fn) {
+	// lines belong to the chunk they start in
+	if(begin > 0) {
+		const char* newline = (const char*)memchr(data + begin - 1, '\n', length - (begin - 1));
+		begin = newline != nullptr ? (size_t)(newline - data) + 1 : length;
+	}
+	size_t count = 0;
+	while(begin < end) {
+		const char* newline = (const char*)memchr(data + begin, '\n', length - begin);
+		size_t lineEnd = newline != nullptr ? (size_t)(newline - data) : length;
+		size_t lineLength = lineEnd - begin;
+		if(lineLength > 0 && data[lineEnd - 1] == '\r') --lineLength;
+		if(lineLength > 0) {
+			fn(data + begin, lineLength);
+			++count;
+		}
+		begin = lineEnd + 1;
+	}
+	return count;
+}
+
+void FileList::clear() {
+	path = nullptr;
+	shardIndex = 0;
+	shardCount = 1;
+	total = 0;
+	file = MappedFile();
+	lines.clear();
+}
+
+bool FileList::load() {
+	lines.clear();
+	if(!file.open(path)) {
+		return false;
+	}
+	const char* data = file.data;
+	size_t length = file.length;
+	size_t chunks = parallelChunkCount(length, 1 << 20);
+	std::vector<std::vector<Line>> selected(chunks);
+	std::vector<size_t> counts(chunks);
+
+	if(selection == Selection::Hash) {
+		parallelChunks(length, chunks, [&](size_t chunk, size_t begin, size_t end) {
+			std::vector<Line>& out = selected[chunk];
+			counts[chunk] = forEachLine(data, length, begin, end, [&](const char* line, size_t lineLength) {
+				if(lineHash(line, lineLength) % shardCount == shardIndex) {
+					out.push_back(Line {line, lineLength});
+				}
+			});
+		});
+	} else {
+		// count the lines of each chunk, then index the chunks overlapping the shard
+		parallelChunks(length, chunks, [&](size_t chunk, size_t begin, size_t end) {
+			counts[chunk] = forEachLine(data, length, begin, end, [](const char*, size_t) {});
+		});
+		size_t lineCount = 0;
+		for(size_t count : counts) lineCount += count;
+		size_t first = lineCount * shardIndex / shardCount;
+		size_t last = lineCount * (shardIndex + 1) / shardCount;
+		std::vector<size_t> firstLines(chunks);
+		for(size_t chunk = 1; chunk < chunks; ++chunk) {
+			firstLines[chunk] = firstLines[chunk - 1] + counts[chunk - 1];
+		}
+		parallelChunks(length, chunks, [&](size_t chunk, size_t begin, size_t end) {
+			size_t line = firstLines[chunk];
+			if(line >= last || line + counts[chunk] <= first) return;
+			std::vector<Line>& out = selected[chunk];
+			forEachLine(data, length, begin, end, [&](const char* text, size_t lineLength) {
+				if(line >= first && line < last) {
+					out.push_back(Line {text, lineLength});
+				}
+				++line;
+			});
+		});
+	}
+
+	total = 0;
+	size_t selectedCount = 0;
+	for(size_t chunk = 0; chunk < chunks; ++chunk) {
+		total += counts[chunk];
+		selectedCount += selected[chunk].size();
+	}
+	lines.reserve(selectedCount);
+	for(std::vector<Line>& chunkLines : selected) {
+		lines.insert(lines.end(), chunkLines.begin(), chunkLines.end());
+	}
+	return true;
+}
+
+static size_t varintLength(uint64_t value) {
+	size_t length = 1;
+	while(value >= 0x80) {
+		value >>= 7;
+		++length;
+	}
+	return length;
+}
+
+static unsigned char* writeVarint(uint64_t value, unsigned char* out) {
+	while(value >= 0x80) {
+		*out++ = (unsigned char)(value | 0x80);
+		value >>= 7;
+	}
+	*out++ = (unsigned char)value;
+	return out;
+}
+
+static bool readVarint(const unsigned char*& in, const unsigned char* end, uint64_t& value) {
+	value = 0;
+	for(int shift = 0; shift < 64 && in < end; shift += 7) {
+		unsigned char byte = *in++;
+		value |= (uint64_t)(byte & 0x7f) << shift;
+		if((byte & 0x80) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+size_t encodedArgumentsLength(int argc, const char* const argv[]) {
+	size_t length = varintLength((uint64_t)(argc > 0 ? argc : 0));
+	for(int i = 0; i < argc; ++i) {
+		size_t argLength = strlen(argv[i]);
+		length += varintLength(argLength) + argLength;
+	}
+	return length;
+}
+
+size_t encodeArguments(int argc, const char* const argv[], unsigned char* out) {
+	unsigned char* cursor = writeVarint((uint64_t)(argc > 0 ? argc : 0), out);
+	for(int i = 0; i < argc; ++i) {
+		size_t argLength = strlen(argv[i]);
+		cursor = writeVarint(argLength, cursor);
+		memcpy(cursor, argv[i], argLength);
+		cursor += argLength;
+	}
+	return (size_t)(cursor - out);
+}
+
+bool decodeArguments(const unsigned char* in, size_t length, std::vector<StringView>& args) {
+	const unsigned char* end = in + length;
+	uint64_t count = 0;
+	// every argument takes at least a byte, which bounds the count before reserving
+	if(!readVarint(in, end, count) || count > (uint64_t)(end - in) || count > INT_MAX) {
+		return false;
+	}
+	args.resize((size_t)count);
+	for(StringView& arg : args) {
+		uint64_t argLength = 0;
+		if(!readVarint(in, end, argLength) || argLength > (uint64_t)(end - in)) {
+			return false;
+		}
+		arg = StringView {(const char*)in, (size_t)argLength};
+		in += argLength;
+	}
+	return in == end;
+}
+
+#if defined(CLI_ENABLE_DESCRIPTIONS)
+static const uint32_t descriptionsMagic = 0x44494c43;	// "CLID"
+
+// Matches are at least this long, shorter repeats are stored as literals
+static const size_t descriptionsMinMatch = 4;
+
+void encodeDescriptions(const char* const names[], const char* const descriptions[], size_t count, std::vector<unsigned char>& out) {
+	std::vector<unsigned char> text;
+	for(size_t i = 0; i < count; ++i) {
+		const char* description = descriptions[i] != nullptr ? descriptions[i] : "";
+		text.insert(text.end(), names[i], names[i] + strlen(names[i]) + 1);
+		text.insert(text.end(), description, description + strlen(description) + 1);
+	}
+
+	out.clear();
+	for(int i = 0; i < 4; ++i) {
+		out.push_back((unsigned char)(descriptionsMagic >> (8 * i)));
+	}
+	unsigned char varint[10];
+	out.insert(out.end(), varint, writeVarint(text.size(), varint));
+	out.insert(out.end(), varint, writeVarint(count, varint));
+
+	// greedy LZ77: a command byte below 0x80 is followed by that many + 1
+	// literal bytes, otherwise it is a match of (command & 0x7f) + 4 bytes
+	// followed by the distance back as a varint
+	const size_t hashSize = 1 << 16;
+	const int maxCandidates = 32;
+	std::vector<int64_t> heads(hashSize, -1);
+	std::vector<int64_t> previous(text.size(), -1);
+	auto hashAt = [&](size_t position) {
+		uint32_t value;
+		memcpy(&value, &text[position], 4);
+		return (value * 2654435761u) >> 16;
+	};
+	auto insert = [&](size_t position) {
+		if(position + descriptionsMinMatch <= text.size()) {
+			uint32_t hash = hashAt(position);
+			previous[position] = heads[hash];
+			heads[hash] = (int64_t)position;
+		}
+	};
+	size_t literalStart = 0;
+	auto flushLiterals = [&](size_t end) {
+		while(literalStart < end) {
+			size_t run = std::min<size_t>(end - literalStart, 128);
+			out.push_back((unsigned char)(run - 1));
+			out.insert(out.end(), text.begin() + literalStart, text.begin() + literalStart + run);
+			literalStart += run;
+		}
+	};
+	size_t position = 0;
+	while(position < text.size()) {
+		size_t bestLength = 0;
+		size_t bestDistance = 0;
+		if(position + descriptionsMinMatch <= text.size()) {
+			size_t limit = std::min<size_t>(text.size() - position, 127 + descriptionsMinMatch);
+			int64_t candidate = heads[hashAt(position)];
+			for(int tries = 0; candidate >= 0 && tries < maxCandidates; ++tries, candidate = previous[candidate]) {
+				size_t length = 0;
+				while(length < limit && text[candidate + length] == text[position + length]) {
+					++length;
+				}
+				if(length > bestLength) {
+					bestLength = length;
+					bestDistance = position - (size_t)candidate;
+				}
+			}
+		}
+		if(bestLength < descriptionsMinMatch) {
+			insert(position);
+			++position;
+			continue;
+		}
+		flushLiterals(position);
+		out.push_back((unsigned char)(0x80 | (bestLength - descriptionsMinMatch)));
+		out.insert(out.end(), varint, writeVarint(bestDistance, varint));
+		for(size_t i = 0; i < bestLength; ++i) {
+			insert(position + i);
+		}
+		position += bestLength;
+		literalStart = position;
+	}
+	flushLiterals(text.size());
+}
+
+bool decodeDescriptions(const unsigned char* in, size_t length, std::vector<char>& text) {
+	const unsigned char* end = in + length;
+	uint32_t magic = 0;
+	for(int i = 0; i < 4 && in < end; ++i) {
+		magic |= (uint32_t)*in++ << (8 * i);
+	}
+	uint64_t textLength = 0;
+	uint64_t count = 0;
+	// a compressed byte expands to at most 131 bytes, which bounds the length before reserving
+	if(magic != descriptionsMagic || !readVarint(in, end, textLength) || !readVarint(in, end, count) ||
+		textLength > (uint64_t)(end - in) * (127 + descriptionsMinMatch)) {
+		return false;
+	}
+	text.clear();
+	text.reserve((size_t)textLength);
+	while(in < end) {
+		unsigned char command = *in++;
+		if(command < 0x80) {
+			size_t run = (size_t)command + 1;
+			if(run > (size_t)(end - in) || text.size() + run > textLength) {
+				return false;
+			}
+			text.insert(text.end(), in, in + run);
+			in += run;
+			continue;
+		}
+		size_t matchLength = (size_t)(command & 0x7f) + descriptionsMinMatch;
+		uint64_t distance = 0;
+		if(!readVarint(in, end, distance) || distance == 0 || distance > text.size() || text.size() + matchLength > textLength) {
+			return false;
+		}
+		// byte by byte, matches may overlap the bytes they produce
+		size_t from = text.size() - (size_t)distance;
+		for(size_t i = 0; i < matchLength; ++i) {
+			text.push_back(text[from + i]);
+		}
+	}
+	if(text.size() != textLength || (!text.empty() && text.back() != '\0')) {
+		return false;
+	}
+	uint64_t strings = 0;
+	for(char c : text) {
+		strings += c == '\0';
+	}
+	return strings == count * 2;
+}
+#endif
+
+#if defined(CLI_ENABLE_CAPTURE)
+// Path of the capture log, read from the environment on first use
+static const char*& captureFile() {
+	static const char* path = secureGetenv("CLI_CAPTURE_FILE");
+	return path;
+}
+
+void setCaptureFile(const char* path) {
+	captureFile() = path;
+}
+
+bool readCapturedLine(const unsigned char*& in, const unsigned char* end, CapturedLine& line) {
+	const unsigned char* cursor = in;
+	uint64_t length = 0;
+	if(!readVarint(cursor, end, length) || length < 8 || length > (uint64_t)(end - cursor)) {
+		return false;
+	}
+	line.fingerprint = 0;
+	for(int i = 0; i < 8; ++i) {
+		line.fingerprint |= (uint64_t)cursor[i] << (8 * i);
+	}
+	line.arguments = cursor + 8;
+	line.length = (size_t)length - 8;
+	in = cursor + length;
+	return true;
+}
+
+// Appends bytes with digits replaced by 1 and letters by a
+static void appendAnonymized(std::vector<unsigned char>& out, const char* data, size_t length) {
+	for(size_t i = 0; i < length; ++i) {
+		unsigned char c = (unsigned char)data[i];
+		if(c >= '0' && c <= '9') {
+			c = '1';
+		} else if((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c >= 0x80) {
+			c = 'a';
+		}
+		out.push_back(c);
+	}
+}
+#endif
+
+uint64_t Parser::fingerprint() const {
+	uint64_t hash = 14695981039346656037ull;
+	auto mix = [&](unsigned char byte) {
+		hash = (hash ^ byte) * 1099511628211ull;
+	};
+	for(const Option& opt : options) {
+		mix((unsigned char)opt.type);
+		mix((unsigned char)opt.isPositional);
+		mix((unsigned char)opt.shortName);
+		for(const char* c = opt.longName; c != nullptr && *c != '\0'; ++c) {
+			mix((unsigned char)*c);
+		}
+		mix(0);
+	}
+	return hash;
+}
+
+#if defined(CLI_ENABLE_CAPTURE)
+void Parser::capture(int argc, const char** argv) {
+#if defined(CLI_HAS_MMAP)
+	const char* path = captureFile();
+	if(path == nullptr || *path == '\0') {
+		return;
+	}
+	std::vector<unsigned char> arguments;
+	unsigned char prefix[10];
+	arguments.insert(arguments.end(), prefix, writeVarint((uint64_t)(argc > 0 ? argc : 0), prefix));
+	for(int i = 0; i < argc; ++i) {
+		const char* arg = argv[i];
+		size_t length = i < (int)argumentLengths.size() ? argumentLengths[i] : strlen(arg);
+		std::vector<unsigned char> anonymized;
+		if(i == 0) {
+			// only the name of the program, without its directory
+			const char* name = arg + length;
+			while(name > arg && name[-1] != '/') {
+				--name;
+			}
+			anonymized.assign(name, arg + length);
+		} else {
+			Token token = classifyToken(arg, length);
+			if(token.kind == Token::Kind::Long) {
+				anonymized.assign(arg, token.name);
+				if(findLongOption(token.name, token.nameLength) != nullptr) {
+					anonymized.insert(anonymized.end(), token.name, token.name + token.nameLength);
+				} else {
+					appendAnonymized(anonymized, token.name, token.nameLength);
+				}
+				if(token.value != nullptr) {
+					anonymized.push_back('=');
+					appendAnonymized(anonymized, token.value, token.valueLength);
+				}
+			} else if(token.kind == Token::Kind::Short) {
+				// known short options are kept up to the first one taking a value
+				anonymized.push_back('-');
+				size_t c = 0;
+				for(; c < token.nameLength; ++c) {
+					unsigned char shortName = (unsigned char)token.name[c];
+					if(shortOffsets[shortName + 1] == shortOffsets[shortName]) {
+						break;
+					}
+					anonymized.push_back(shortName);
+					if(options[shortIndices[shortOffsets[shortName]]].requiresParameter()) {
+						++c;
+						break;
+					}
+				}
+				appendAnonymized(anonymized, token.name + c, token.nameLength - c);
+			} else {
+				appendAnonymized(anonymized, arg, length);
+			}
+		}
+		arguments.insert(arguments.end(), prefix, writeVarint(anonymized.size(), prefix));
+		arguments.insert(arguments.end(), anonymized.begin(), anonymized.end());
+	}
+
+	std::vector<unsigned char> record(prefix, writeVarint(8 + arguments.size(), prefix));
+	uint64_t hash = fingerprint();
+	for(int i = 0; i < 8; ++i) {
+		record.push_back((unsigned char)(hash >> (8 * i)));
+	}
+	record.insert(record.end(), arguments.begin(), arguments.end());
+	int fd = ::open(path, O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0600);
+	if(fd < 0) {
+		return;
+	}
+	ssize_t written = write(fd, record.data(), record.size());
+	(void)written;
+	close(fd);
+#else
+	(void)argc;
+	(void)argv;
+#endif
+}
+#else
+void Parser::capture(int, const char**) {
+}
+#endif
+
+// Size of the value bound to options that can be copied bytewise, 0 for others
+static size_t valueSize(Option::Type type) {
+	switch(type) {
+		case Option::Type::Flag:
+			return sizeof(bool);
+		case Option::Type::FlagCount:
+		case Option::Type::Int:
+			return sizeof(int);
+		case Option::Type::Float:
+			return sizeof(float);
+		case Option::Type::String:
+		case Option::Type::Path:
+		case Option::Type::PathExisting:
+			return sizeof(const char*);
+		case Option::Type::Decimal:
+		case Option::Type::Int64:
+			return sizeof(int64_t);
+		case Option::Type::Double:
+			return sizeof(double);
+		case Option::Type::Hex:
+		case Option::Type::Base64:
+			return sizeof(Blob);
+		case Option::Type::SecretFd:
+			return sizeof(Secret);
+		case Option::Type::StringView:
+			return sizeof(StringView);
+		default:
+			return 0;
+	}
+}
+
+#if defined(CLI_ENABLE_VALIDATION_CACHE)
+// Whether a validated option's value, given with the effective policy, can be reused for another line
+static bool isCacheable(const Option& opt, RepeatPolicy policy) {
+	switch(opt.type) {
+		case Option::Type::Flag:
+		case Option::Type::FlagCount:
+		case Option::Type::Int:
+		case Option::Type::Float:
+		case Option::Type::Decimal:
+		case Option::Type::Int64:
+		case Option::Type::Double:
+		case Option::Type::String:
+		case Option::Type::Path:
+			return !opt.valueFromFile && policy != RepeatPolicy::Accumulate;
+		default:
+			return false;
+	}
+}
+#endif
+
+void Parser::reset() {
+	if(defaultOffsets.empty()) {
+		// capture the defaults the first time
+		for(Option& opt : options) {
+			defaultOffsets.push_back(defaults.size());
+			size_t size = valueSize(opt.type);
+			defaults.insert(defaults.end(), (unsigned char*)opt.valuePointer, (unsigned char*)opt.valuePointer + size);
+		}
+	}
+	for(size_t i = 0; i < options.size(); ++i) {
+		Option& opt = options[i];
+		opt.isSet = false;
+		size_t size = valueSize(opt.type);
+		if(size > 0) {
+			memcpy(opt.valuePointer, defaults.data() + defaultOffsets[i], size);
+		}
+		switch(opt.type) {
+			case Option::Type::Glob:
+			case Option::Type::Regex:
+				opt.as<Pattern>() = Pattern();
+				break;
+			case Option::Type::Int64List:
+				opt.as<std::vector<int64_t>>().clear();
+				break;
+			case Option::Type::DoubleList:
+				opt.as<std::vector<double>>().clear();
+				break;
+			case Option::Type::PathList:
+				opt.as<std::vector<const char*>>().clear();
+				break;
+			case Option::Type::FilesFrom:
+				opt.as<FileList>().clear();
+				break;
+			default:
+				break;
+		}
+	}
+	remaining.clear();
+	storage.clear();
+	mappedFiles.clear();
+	lockedBuffers.clear();
+	nextPositional = 0;
+	listIndices.clear();
+	passThroughRanges.clear();
+	passThroughArgv.assign(2, nullptr);
+	accumulatedValues.clear();
+	deferredPositionals.clear();
+	lazyValues.clear();
+	lazyStates.clear();
+}
+
+#if defined(CLI_ENABLE_VALIDATION_CACHE)
+bool Parser::handleDeferredPositionals() {
+	for(int index : deferredPositionals) {
+		if(!handlePositional(argumentView(index), index)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool Parser::validate(int argc, const char* argv[], ValidationCache& cache) {
+	reset();
+	if(passThroughMode != PassThrough::None || lazy || cache.capacity == 0) {
+		return parse(argc, argv);
+	}
+	if(cache.owner != this) {
+		cache.clear();
+		cache.owner = this;
+	}
+
+	beginParse(argc, argv);
+	uint64_t hash = cache.buildKey(*this, argc, argv);
+	if(ValidationCache::Entry* entry = cache.find(hash)) {
+		++cache.hits;
+		entry->referenced = true;
+		if(!entry->valid) {
+			return false;
+		}
+		for(const ValidationCache::Value& value : entry->values) {
+			Option& opt = options[value.option];
+			opt.isSet = true;
+			if(value.token >= 0) {
+				opt.as<const char*>() = argv[value.token] + value.tokenOffset;
+			} else {
+				memcpy(opt.valuePointer, entry->data.data() + value.offset, valueSize(opt.type));
+			}
+		}
+		// identical keys place the positional arguments at the same indices
+		deferredPositionals = entry->positionals;
+		return handleDeferredPositionals() && finishParse();
+	}
+	++cache.misses;
+
+	deferPositionals = true;
+	bool valid = parseArguments(argc, argv);
+	deferPositionals = false;
+
+	bool cacheable = true;
+	for(Option& opt : options) {
+		cacheable &= !opt.isSet || isCacheable(opt, repeatPolicyOf(opt));
+	}
+	if(cacheable) {
+		ValidationCache::Entry& entry = cache.insert(hash);
+		entry.valid = valid;
+		for(size_t i = 0; valid && i < options.size(); ++i) {
+			Option& opt = options[i];
+			if(!opt.isSet) continue;
+			ValidationCache::Value value = {(uint32_t)i, (uint32_t)entry.data.size(), -1, 0};
+			if(opt.type == Option::Type::String || opt.type == Option::Type::Path) {
+				// strings point into the arguments, find the one to rebase them on another line
+				const char* str = opt.as<const char*>();
+				for(int j = 1; j < argc && value.token < 0; ++j) {
+					if(str >= argv[j] && str <= argv[j] + strlen(argv[j])) {
+						value.token = j;
+						value.tokenOffset = (size_t)(str - argv[j]);
+					}
+				}
+			}
+			size_t size = valueSize(opt.type);
+			entry.data.insert(entry.data.end(), (unsigned char*)opt.valuePointer, (unsigned char*)opt.valuePointer + size);
+			entry.values.push_back(value);
+		}
+		entry.positionals = deferredPositionals;
+	}
+	return valid && handleDeferredPositionals() && finishParse();
+}
+
+size_t Parser::validateBatch(const CommandLine* lines, size_t count, bool* results, ValidationCache& cache) {
+	size_t valid = 0;
+	for(size_t i = 0; i < count; ++i) {
+		results[i] = validate(lines[i].argc, lines[i].argv, cache);
+		valid += results[i] ? 1 : 0;
+	}
+	return valid;
+}
+
+void ValidationCache::clear() {
+	entries.clear();
+	slots.clear();
+	hand = 0;
+	owner = nullptr;
+}
+
+// Options and the arguments that may be their values are part of the key,
+// other arguments can only be positional and are replaced by a marker
+uint64_t ValidationCache::buildKey(Parser& parser, int argc, const char** argv) {
+	key.clear();
+	bool mayBeValue = false;
+	for(int i = 1; i < argc; ++i) {
+		const char* arg = argv[i];
+		Token token = parser.classifyToken(arg);
+		if(token.kind != Token::Kind::Positional || mayBeValue) {
+			key.insert(key.end(), arg, arg + strlen(arg) + 1);
+		} else {
+			key.push_back('\x01');
+		}
+		// options known not to take the next argument
+		Option* opt = nullptr;
+		if(token.kind == Token::Kind::Long) {
+			opt = token.value != nullptr ? nullptr : parser.findLongOption(token.name, token.nameLength);
+			mayBeValue = token.value == nullptr && (opt == nullptr || opt->requiresParameter());
+		} else if(token.kind == Token::Kind::Short && token.nameLength == 1) {
+			for(Option& candidate : parser.options) {
+				if(candidate.shortName == token.name[0] && !candidate.isPositional) opt = &candidate;
+			}
+			mayBeValue = opt == nullptr || opt->requiresParameter();
+		} else {
+			mayBeValue = token.kind == Token::Kind::Short;
+		}
+	}
+	// FNV-1a
+	uint64_t hash = 14695981039346656037ull;
+	for(char c : key) {
+		hash = (hash ^ (unsigned char)c) * 1099511628211ull;
+	}
+	return hash;
+}
+
+ValidationCache::Entry* ValidationCache::find(uint64_t hash) {
+	auto slot = slots.find(hash);
+	if(slot == slots.end()) {
+		return nullptr;
+	}
+	Entry& entry = entries[slot->second];
+	if(entry.key.size() != key.size() || memcmp(entry.key.data(), key.data(), key.size()) != 0) {
+		return nullptr;
+	}
+	return &entry;
+}
+
+ValidationCache::Entry& ValidationCache::insert(uint64_t hash) {
+	size_t index;
+	auto existing = slots.find(hash);
+	if(existing != slots.end()) {
+		// replaces a colliding entry
+		index = existing->second;
+	} else if(entries.size() < capacity) {
+		index = entries.size();
+		entries.emplace_back();
+	} else {
+		// CLOCK: skip entries used since the hand last passed them
+		while(entries[hand].referenced) {
+			entries[hand].referenced = false;
+			hand = (hand + 1) % entries.size();
+		}
+		index = hand;
+		hand = (hand + 1) % entries.size();
+		slots.erase(entries[index].hash);
+	}
+	Entry& entry = entries[index];
+	entry.hash = hash;
+	entry.key = key;
+	entry.valid = false;
+	entry.referenced = false;
+	entry.values.clear();
+	entry.data.clear();
+	entry.positionals.clear();
+	slots[hash] = index;
+	return entry;
+}
+#endif
+
+#if defined(CLI_ENABLE_SHARED_VALUES)
+// Byte image of a snapshot, the same on both sides of the memfd
+static const uint32_t sharedValuesMagic = 0x564c4943;	// "CILV"
+
+static bool isStringType(Option::Type type) {
+	return type == Option::Type::String || type == Option::Type::Path || type == Option::Type::PathExisting;
+}
+
+static bool isBlobType(Option::Type type) {
+	return type == Option::Type::Hex || type == Option::Type::Base64;
+}
+
+static size_t alignOffset(size_t offset) {
+	return (offset + 7) & ~(size_t)7;
+}
+
+SharedValues::SharedValues(SharedValues&& other) : data(other.data), length(other.length), descriptor(other.descriptor) {
+	other.data = nullptr;
+	other.length = 0;
+	other.descriptor = -1;
+}
+
+SharedValues& SharedValues::operator=(SharedValues&& other) {
+	if(this != &other) {
+		close();
+		data = other.data;
+		length = other.length;
+		descriptor = other.descriptor;
+		other.data = nullptr;
+		other.length = 0;
+		other.descriptor = -1;
+	}
+	return *this;
+}
+
+SharedValues::~SharedValues() {
+	close();
+}
+
+const SharedValues::Record* SharedValues::find(const char* longName) const {
+	if(data == nullptr) {
+		return nullptr;
+	}
+	const Header* header = (const Header*)data;
+	const Record* records = (const Record*)(data + sizeof(Header));
+	size_t nameLength = strlen(longName);
+	size_t low = 0;
+	size_t high = header->count;
+	while(low < high) {
+		size_t middle = low + (high - low) / 2;
+		const Record& record = records[middle];
+		int order = compareNames((const char*)data + record.nameOffset, record.nameLength, longName, nameLength);
+		if(order == 0) {
+			return &record;
+		}
+		if(order < 0) {
+			low = middle + 1;
+		} else {
+			high = middle;
+		}
+	}
+	return nullptr;
+}
+
+bool SharedValues::isSet(const char* longName) const {
+	const Record* record = find(longName);
+	return record != nullptr && record->isSet;
+}
+
+const void* SharedValues::scalar(const char* longName, size_t size) const {
+	const Record* record = find(longName);
+	if(record == nullptr || record->valueLength != size || isStringType((Option::Type)record->type) || isBlobType((Option::Type)record->type)) {
+		return nullptr;
+	}
+	return data + record->valueOffset;
+}
+
+const char* SharedValues::getString(const char* longName) const {
+	const Record* record = find(longName);
+	if(record == nullptr || !isStringType((Option::Type)record->type) || record->valueOffset == 0) {
+		return nullptr;
+	}
+	return (const char*)data + record->valueOffset;
+}
+
+Blob SharedValues::getBlob(const char* longName) const {
+	Blob blob = {};
+	const Record* record = find(longName);
+	if(record != nullptr && isBlobType((Option::Type)record->type) && record->valueOffset != 0) {
+		blob.data = data + record->valueOffset;
+		blob.length = record->valueLength;
+	}
+	return blob;
+}
+
+bool SharedValues::create(const Parser& parser) {
+	close();
+	std::vector<OptionName> names;
+	for(size_t i = 0; i < parser.options.size(); ++i) {
+		if(parser.options[i].longName != nullptr) {
+			names.push_back(OptionName {parser.options[i].longName, strlen(parser.options[i].longName), i});
+		}
+	}
+	std::stable_sort(names.begin(), names.end(), optionNameLess);
+
+	std::vector<unsigned char> image(sizeof(Header) + names.size() * sizeof(Record));
+	auto append = [&image](const void* bytes, size_t size) {
+		size_t offset = alignOffset(image.size());
+		image.resize(offset + size);
+		memcpy(image.data() + offset, bytes, size);
+		return (uint32_t)offset;
+	};
+	std::vector<Record> records(names.size());
+	for(size_t i = 0; i < names.size(); ++i) {
+		const Option& opt = parser.options[names[i].option];
+		Record& record = records[i];
+		record = Record {};
+		record.type = (uint8_t)opt.type;
+		record.isSet = opt.isSet ? 1 : 0;
+		record.nameLength = (uint32_t)names[i].length;
+		record.nameOffset = append(names[i].name, names[i].length + 1);
+		const void* value = nullptr;
+		size_t valueLength = 0;
+		if(isStringType(opt.type)) {
+			value = opt.as<const char*>();
+			valueLength = value != nullptr ? strlen((const char*)value) + 1 : 0;
+		} else if(opt.type == Option::Type::StringView) {
+			// stored as a NUL-terminated string
+			const StringView& view = opt.as<StringView>();
+			if(view.data != nullptr) {
+				std::vector<char> copy(view.data, view.data + view.length);
+				copy.push_back('\0');
+				record.type = (uint8_t)Option::Type::String;
+				record.valueOffset = append(copy.data(), copy.size());
+				record.valueLength = (uint32_t)view.length;
+			}
+		} else if(isBlobType(opt.type)) {
+			value = opt.as<Blob>().data;
+			valueLength = value != nullptr ? opt.as<Blob>().length : 0;
+		} else if(opt.type != Option::Type::SecretFd) {
+			value = opt.valuePointer;
+			valueLength = valueSize(opt.type);
+		}
+		if(value != nullptr && valueLength > 0) {
+			record.valueOffset = append(value, valueLength);
+			// the terminator isn't part of a string's length
+			record.valueLength = (uint32_t)(isStringType(opt.type) ? valueLength - 1 : valueLength);
+		}
+	}
+	Header header = {sharedValuesMagic, 1, image.size(), (uint32_t)names.size(), 0};
+	memcpy(image.data(), &header, sizeof(header));
+	if(!records.empty()) {
+		memcpy(image.data() + sizeof(Header), records.data(), records.size() * sizeof(Record));
+	}
+
+#if defined(CLI_HAS_MEMFD)
+	int fd = memfd_create("cli-values", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+	if(fd < 0) {
+		return false;
+	}
+	size_t written = 0;
+	while(written < image.size()) {
+		ssize_t result = write(fd, image.data() + written, image.size() - written);
+		if(result < 0 && errno == EINTR) continue;
+		if(result <= 0) {
+			::close(fd);
+			return false;
+		}
+		written += (size_t)result;
+	}
+	if(fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL) != 0 || !open(fd)) {
+		::close(fd);
+		return false;
+	}
+	descriptor = fd;
+	return true;
+#else
+	return false;
+#endif
+}
+
+// Whether the header and every record of a mapped snapshot are within its size
+bool SharedValues::isValid(const unsigned char* data, size_t size) {
+	const Header* header = (const Header*)data;
+	if(header->magic != sharedValuesMagic || header->version != 1 || header->size != size ||
+		header->count > (size - sizeof(Header)) / sizeof(Record)) {
+		return false;
+	}
+	const Record* records = (const Record*)(data + sizeof(Header));
+	for(uint32_t i = 0; i < header->count; ++i) {
+		const Record& record = records[i];
+		// names are NUL-terminated
+		if(record.nameOffset >= size || record.nameLength >= size - record.nameOffset || data[record.nameOffset + record.nameLength] != '\0') {
+			return false;
+		}
+		if(record.valueOffset == 0) {
+			continue;
+		}
+		// values are aligned, strings are NUL-terminated too
+		bool isString = isStringType((Option::Type)record.type);
+		if(record.valueOffset % 8 != 0 || record.valueOffset >= size || record.valueLength > size - record.valueOffset - (isString ? 1 : 0) ||
+			(isString && data[record.valueOffset + record.valueLength] != '\0')) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool SharedValues::open(int fd) {
+	close();
+#if defined(CLI_HAS_MMAP)
+	struct stat info;
+	if(fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(Header)) {
+		return false;
+	}
+#if defined(CLI_HAS_MEMFD)
+	// an unsealed file could change under the checks below, or shrink and fault on access
+	int seals = fcntl(fd, F_GET_SEALS);
+	if(seals < 0 || (seals & (F_SEAL_SHRINK | F_SEAL_WRITE)) != (F_SEAL_SHRINK | F_SEAL_WRITE)) {
+		return false;
+	}
+#endif
+	size_t size = (size_t)info.st_size;
+	void* memory = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+	if(memory == MAP_FAILED) {
+		return false;
+	}
+	if(!isValid((const unsigned char*)memory, size)) {
+		munmap(memory, size);
+		return false;
+	}
+	data = (const unsigned char*)memory;
+	length = size;
+	return true;
+#else
+	return false;
+#endif
+}
+
+void SharedValues::close() {
+#if defined(CLI_HAS_MMAP)
+	if(data != nullptr) {
+		munmap((void*)data, length);
+	}
+	if(descriptor >= 0) {
+		::close(descriptor);
+	}
+#endif
+	data = nullptr;
+	length = 0;
+	descriptor = -1;
+}
+#endif
+
+// Referenced by the parser, counting itself needs CLI_ENABLE_USAGE_COUNTERS
+void UsageSegment::increment(uint64_t* counter) {
+	((std::atomic<uint64_t>*)counter)->fetch_add(1, std::memory_order_relaxed);
+}
+
+#if defined(CLI_ENABLE_USAGE_COUNTERS)
+static const uint32_t usageMagic = 0x55494c43;	// "CLIU"
+
+void setUsageDirectory(const char* path) {
+	usageDirectory() = path;
+}
+
+UsageSegment::UsageSegment(UsageSegment&& other) : header(other.header), length(other.length), names(other.names), nameOffsets(std::move(other.nameOffsets)) {
+	other.header = nullptr;
+	other.length = 0;
+	other.names = nullptr;
+}
+
+UsageSegment& UsageSegment::operator=(UsageSegment&& other) {
+	if(this != &other) {
+		close();
+		header = other.header;
+		length = other.length;
+		names = other.names;
+		nameOffsets = std::move(other.nameOffsets);
+		other.header = nullptr;
+		other.length = 0;
+		other.names = nullptr;
+	}
+	return *this;
+}
+
+UsageSegment::~UsageSegment() {
+	close();
+}
+
+uint64_t UsageSegment::fingerprint() const {
+	return header != nullptr ? header->fingerprint : 0;
+}
+
+uint64_t UsageSegment::parses() const {
+	return header != nullptr ? ((std::atomic<uint64_t>*)&header->parses)->load(std::memory_order_relaxed) : 0;
+}
+
+size_t UsageSegment::optionCount() const {
+	return nameOffsets.size();
+}
+
+const char* UsageSegment::name(size_t option) const {
+	return option < nameOffsets.size() ? names + nameOffsets[option] : nullptr;
+}
+
+uint64_t UsageSegment::count(size_t option) const {
+	return option < nameOffsets.size() ? ((std::atomic<uint64_t>*)(counters() + option))->load(std::memory_order_relaxed) : 0;
+}
+
+#if defined(CLI_HAS_MMAP)
+bool UsageSegment::attach(const char* directory, const Parser& parser) {
+	close();
+	uint64_t hash = parser.fingerprint();
+	size_t directoryLength = strlen(directory);
+	std::vector<char> path(directoryLength + 64);
+	snprintf(path.data(), path.size(), "%s/%016llx.usage", directory, (unsigned long long)hash);
+
+	int fd = ::open(path.data(), O_RDWR | O_CLOEXEC);
+	if(fd < 0 && errno == ENOENT) {
+		// the segment is written under a temporary name and published with
+		// link(), so that other processes never map a partial segment
+		std::vector<unsigned char> contents(sizeof(Header) + parser.options.size() * sizeof(uint64_t));
+		for(const Option& opt : parser.options) {
+			const char* name = opt.longName != nullptr ? opt.longName : "";
+			contents.insert(contents.end(), name, name + strlen(name) + 1);
+		}
+		Header* created = (Header*)contents.data();
+		created->magic = usageMagic;
+		created->version = 1;
+		created->fingerprint = hash;
+		created->optionCount = parser.options.size();
+		created->namesLength = contents.size() - sizeof(Header) - parser.options.size() * sizeof(uint64_t);
+
+		// unique among the parsers of this process, names left by crashed
+		// processes with the same pid are skipped
+		static std::atomic<unsigned> temporaryCount(0);
+		std::vector<char> temporary(path.size() + 40);
+		int temporaryFd = -1;
+		for(int attempt = 0; temporaryFd < 0 && attempt < 100; ++attempt) {
+			snprintf(temporary.data(), temporary.size(), "%s.%ld.%u", path.data(), (long)getpid(), temporaryCount++);
+			temporaryFd = ::open(temporary.data(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0666);
+			if(temporaryFd < 0 && errno != EEXIST) {
+				return false;
+			}
+		}
+		if(temporaryFd < 0) {
+			return false;
+		}
+		bool written = write(temporaryFd, contents.data(), contents.size()) == (ssize_t)contents.size();
+		::close(temporaryFd);
+		if(written && link(temporary.data(), path.data()) != 0 && errno != EEXIST) {
+			written = false;
+		}
+		unlink(temporary.data());
+		if(!written) {
+			return false;
+		}
+		fd = ::open(path.data(), O_RDWR | O_CLOEXEC);
+	}
+	if(fd < 0) {
+		return false;
+	}
+	bool mapped = map(fd, true);
+	::close(fd);
+	if(mapped && (header->fingerprint != hash || nameOffsets.size() != parser.options.size())) {
+		close();
+		return false;
+	}
+	return mapped;
+}
+
+bool UsageSegment::open(const char* path) {
+	close();
+	int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+	if(fd < 0) {
+		return false;
+	}
+	bool mapped = map(fd, false);
+	::close(fd);
+	return mapped;
+}
+
+bool UsageSegment::map(int fd, bool writable) {
+	struct stat info;
+	if(fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(Header)) {
+		return false;
+	}
+	size_t size = (size_t)info.st_size;
+	void* mapping = mmap(nullptr, size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+	if(mapping == MAP_FAILED) {
+		return false;
+	}
+	header = (Header*)mapping;
+	length = size;
+	// the counts and names must fill the rest of the segment
+	uint64_t countersLength = header->optionCount * sizeof(uint64_t);
+	if(header->magic != usageMagic || header->version != 1 || header->optionCount > size / sizeof(uint64_t) ||
+		sizeof(Header) + countersLength + header->namesLength != size) {
+		close();
+		return false;
+	}
+	names = (const char*)mapping + sizeof(Header) + countersLength;
+	nameOffsets.clear();
+	uint32_t offset = 0;
+	while(offset < header->namesLength) {
+		const char* end = (const char*)memchr(names + offset, '\0', header->namesLength - offset);
+		if(end == nullptr) {
+			break;
+		}
+		nameOffsets.push_back(offset);
+		offset = (uint32_t)(end - names) + 1;
+	}
+	if(offset != header->namesLength || nameOffsets.size() != header->optionCount) {
+		close();
+		return false;
+	}
+	return true;
+}
+#else
+bool UsageSegment::attach(const char*, const Parser&) {
+	return false;
+}
+
+bool UsageSegment::open(const char*) {
+	return false;
+}
+
+bool UsageSegment::map(int, bool) {
+	return false;
+}
+#endif
+
+void UsageSegment::close() {
+#if defined(CLI_HAS_MMAP)
+	if(header != nullptr) {
+		munmap((void*)header, length);
+	}
+#endif
+	header = nullptr;
+	length = 0;
+	names = nullptr;
+	nameOffsets.clear();
+}
+#endif
+
+Option OptionFlag(char shortName, const char* longName, const char* description, bool* valuePointer){
+	return Option {Option::Type::Flag, shortName, longName, description, false, false, valuePointer};
+}
+
+Option OptionFlagCount(char shortName, const char* longName, const char* description, int* valuePointer){
+	return Option {Option::Type::FlagCount, shortName, longName, description, false, false, valuePointer};
+}
+
+Option OptionInt(char shortName, const char* longName, const char* description, bool required, int* valuePointer){
+	return Option {Option::Type::Int, shortName, longName, description, required, false, valuePointer};
+}
+
+Option OptionFloat(char shortName, const char* longName, const char* description, bool required, float* valuePointer){
+	return Option {Option::Type::Float, shortName, longName, description, required, false, valuePointer};
+}
+
+Option OptionInt64(char shortName, const char* longName, const char* description, bool required, int64_t* valuePointer){
+	return Option {Option::Type::Int64, shortName, longName, description, required, false, valuePointer};
+}
+
+Option OptionDouble(char shortName, const char* longName, const char* description, bool required, double* valuePointer){
+	return Option {Option::Type::Double, shortName, longName, description, required, false, valuePointer};
+}
+
+Option OptionString(char shortName, const char* longName, const char* description, bool required, const char** valuePointer){
+	return Option {Option::Type::String, shortName, longName, description, required, false, valuePointer};
+}
+
+Option OptionStringView(char shortName, const char* longName, const char* description, bool required, StringView* valuePointer){
+	return Option {Option::Type::StringView, shortName, longName, description, required, false, valuePointer};
+}
+
+Option OptionPath(char shortName, const char* longName, const char* description, bool required, const char** valuePointer){
+	return Option {Option::Type::Path, shortName, longName, description, required, false, valuePointer};
+}
+
+Option OptionPathExisting(char shortName, const char* longName, const char* description, bool required, const char** valuePointer){
+	return Option {Option::Type::PathExisting, shortName, longName, description, required, false, valuePointer};
+}
+
+Option OptionDecimal(char shortName, const char* longName, const char* description, bool required, int fractionalDigits, int64_t* valuePointer){
+	Option option = {Option::Type::Decimal, shortName, longName, description, required, false, valuePointer};
+	option.fractionalDigits = fractionalDigits;
+	return option;
+}
+
+Option OptionHex(char shortName, const char* longName, const char* description, bool required, Blob* valuePointer){
+	return Option {Option::Type::Hex, shortName, longName, description, required, false, valuePointer};
+}
+
+Option OptionBase64(char shortName, const char* longName, const char* description, bool required, Blob* valuePointer){
+	return Option {Option::Type::Base64, shortName, longName, description, required, false, valuePointer};
+}
+
+Option OptionSecretFd(char shortName, const char* longName, const char* description, bool required, Secret* valuePointer){
+	return Option {Option::Type::SecretFd, shortName, longName, description, required, false, valuePointer};
+}
+
+Option OptionGlob(char shortName, const char* longName, const char* description, bool required, Pattern* valuePointer){
+	return Option {Option::Type::Glob, shortName, longName, description, required, false, valuePointer};
+}
+
+Option OptionRegex(char shortName, const char* longName, const char* description, bool required, Pattern* valuePointer){
+	return Option {Option::Type::Regex, shortName, longName, description, required, false, valuePointer};
+}
+
+Option OptionFilesFrom(char shortName, const char* longName, const char* description, bool required, FileList* valuePointer){
+	return Option {Option::Type::FilesFrom, shortName, longName, description, required, false, valuePointer};
+}
+
+Option OptionShard(char shortName, const char* longName, const char* description, bool required, FileList* valuePointer){
+	return Option {Option::Type::Shard, shortName, longName, description, required, false, valuePointer};
+}
+
+static Option positional(Option option) {
+	option.isPositional = true;
+	return option;
+}
+
+Option PositionalInt64(const char* name, const char* description, bool required, int64_t* valuePointer){
+	return positional(Option {Option::Type::Int64, 0, name, description, required, false, valuePointer});
+}
+
+Option PositionalDouble(const char* name, const char* description, bool required, double* valuePointer){
+	return positional(Option {Option::Type::Double, 0, name, description, required, false, valuePointer});
+}
+
+Option PositionalPath(const char* name, const char* description, bool required, const char** valuePointer){
+	return positional(Option {Option::Type::Path, 0, name, description, required, false, valuePointer});
+}
+
+Option RemainingInt64(const char* name, const char* description, bool required, std::vector<int64_t>* valuePointer){
+	return positional(Option {Option::Type::Int64List, 0, name, description, required, false, valuePointer});
+}
+
+Option RemainingDouble(const char* name, const char* description, bool required, std::vector<double>* valuePointer){
+	return positional(Option {Option::Type::DoubleList, 0, name, description, required, false, valuePointer});
+}
+
+Option RemainingPaths(const char* name, const char* description, bool required, std::vector<const char*>* valuePointer){
+	return positional(Option {Option::Type::PathList, 0, name, description, required, false, valuePointer});
+}
+
+Option OptionalValue(Option option, const char* implicitValue){
+	option.implicitValue = implicitValue;
+	return option;
+}
+
+Option OnRepeat(Option option, RepeatPolicy policy){
+	option.repeatPolicy = policy;
+	return option;
+}
+
+Option ValueFromFile(Option option){
+	option.valueFromFile = true;
+	return option;
+}
+
+LeanParser::LeanParser(const Option* options, size_t count) : impl(new Parser(std::vector<Option>(options, options + count))) {
+	// captures the defaults restored by reset()
+	impl->reset();
+}
+
+LeanParser::~LeanParser() {
+	delete impl;
+}
+
+bool LeanParser::parse(int argc, const char* argv[]) {
+	return impl->parse(argc, argv);
+}
+
+void LeanParser::reset() {
+	impl->reset();
+}
+
+void LeanParser::printOptionsUsage() {
+	impl->printOptionsUsage();
+}
+
+bool LeanParser::isSet(size_t option) const {
+	return impl->isSet(option);
+}
+
+size_t LeanParser::remainingCount() const {
+	return impl->getRemainingArgs().size();
+}
+
+const char* LeanParser::remaining(size_t index) const {
+	return index < impl->getRemainingArgs().size() ? impl->getRemainingArgs()[index] : nullptr;
+}
+
+MappedFile::MappedFile(MappedFile&& other) : data(other.data), length(other.length), mappedLength(other.mappedLength), contents(std::move(other.contents)) {
+	other.data = nullptr;
+	other.length = 0;
+	other.mappedLength = 0;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) {
+	if(this != &other) {
+		close();
+		data = other.data;
+		length = other.length;
+		mappedLength = other.mappedLength;
+		contents = std::move(other.contents);
+		other.data = nullptr;
+		other.length = 0;
+		other.mappedLength = 0;
+	}
+	return *this;
+}
+
+MappedFile::~MappedFile() {
+	close();
+}
+
+#if defined(CLI_HAS_MMAP)
+bool MappedFile::open(const char* path) {
+	close();
+	int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+	if(fd < 0) {
+		return false;
+	}
+	struct stat info;
+	if(fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+		::close(fd);
+		return false;
+	}
+	size_t size = (size_t)info.st_size;
+	size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+	// Reserve an extra zeroed page past the end of the file so the contents
+	// are NUL-terminated even when the file size is a multiple of the page size
+	size_t reserved = (size + pageSize) / pageSize * pageSize;
+	void* base = mmap(nullptr, reserved, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if(base == MAP_FAILED) {
+		::close(fd);
+		return false;
+	}
+	if(size > 0 && mmap(base, size, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+		munmap(base, reserved);
+		::close(fd);
+		return false;
+	}
+	::close(fd);
+	data = (const char*)base;
+	length = size;
+	mappedLength = reserved;
+	return true;
+}
+
+void MappedFile::close() {
+	if(mappedLength > 0) {
+		munmap((void*)data, mappedLength);
+	}
+	data = nullptr;
+	length = 0;
+	mappedLength = 0;
+}
+#else
+bool MappedFile::open(const char* path) {
+	close();
+	FILE* f = fopen(path, "rb");
+	if(f == NULL) {
+		return false;
+	}
+	char buffer[4096];
+	size_t count;
+	while((count = fread(buffer, 1, sizeof(buffer), f)) > 0) {
+		contents.insert(contents.end(), buffer, buffer + count);
+	}
+	bool failed = ferror(f) != 0;
+	fclose(f);
+	if(failed) {
+		contents.clear();
+		return false;
+	}
+	length = contents.size();
+	contents.push_back('\0');
+	data = contents.data();
+	return true;
+}
+
+void MappedFile::close() {
+	contents.clear();
+	data = nullptr;
+	length = 0;
+}
+#endif
+
+LockedBuffer::LockedBuffer(LockedBuffer&& other) : data(other.data), size(other.size) {
+	other.data = nullptr;
+	other.size = 0;
+}
+
+LockedBuffer& LockedBuffer::operator=(LockedBuffer&& other) {
+	if(this != &other) {
+		release();
+		data = other.data;
+		size = other.size;
+		other.data = nullptr;
+		other.size = 0;
+	}
+	return *this;
+}
+
+LockedBuffer::~LockedBuffer() {
+	release();
+}
+
+#if defined(CLI_HAS_MMAP)
+bool LockedBuffer::allocate(size_t requestedSize) {
+	release();
+	size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+	size_t mappedSize = (requestedSize + pageSize - 1) / pageSize * pageSize;
+	void* memory = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if(memory == MAP_FAILED) {
+		return false;
+	}
+	if(mlock(memory, mappedSize) != 0) {
+		munmap(memory, mappedSize);
+		return false;
+	}
+#if defined(MADV_DONTDUMP)
+	madvise(memory, mappedSize, MADV_DONTDUMP);
+#endif
+	data = (char*)memory;
+	size = mappedSize;
+	return true;
+}
+
+void LockedBuffer::release() {
+	if(data != nullptr) {
+		// volatile so the compiler can't drop the stores to memory that is about to be freed
+		volatile char* bytes = data;
+		for(size_t i = 0; i < size; ++i) {
+			bytes[i] = 0;
+		}
+		munlock(data, size);
+		munmap(data, size);
+	}
+	data = nullptr;
+	size = 0;
+}
+#else
+bool LockedBuffer::allocate(size_t requestedSize) {
+	return false;
+}
+
+void LockedBuffer::release() {
+}
+#endif
 
 }; // end namespace
 
@@ -0,0 +1,366 @@
+// Implementation of the C interface in cli_c.h
+
+#include <stdarg.h>
+#include <new>
+#include <string>
+
+// error messages are collected into the parser being used by the calling thread
+static thread_local std::string* parserErrors = nullptr;
+
+static void logParserError(const char* fmt, ...) {
+	if(parserErrors == nullptr) {
+		return;
+	}
+	va_list args;
+	va_start(args, fmt);
+	char message[512];
+	int length = vsnprintf(message, sizeof(message), fmt, args);
+	va_end(args);
+	if(length > 0) {
+		parserErrors->append(message, (size_t)length < sizeof(message) ? (size_t)length : sizeof(message) - 1);
+	}
+}
+
+#define CLI_LOG_ERROR(fmt, ...) logParserError(fmt, ##__VA_ARGS__)
+#define CLI_ENABLE_ALL 1
+#include "cli.h"
+#include "cli_c.h"
+
+struct SpecOption {
+	cli_type type;
+	bool positional;
+	char shortName;
+	std::string longName;
+	std::string description;
+	bool required;
+	int fractionalDigits;
+};
+
+struct cli_spec {
+	std::vector<SpecOption> options;
+};
+
+// Variables bound to an option
+struct Slot {
+	bool flag;
+	int count;
+	int64_t integer;
+	double number;
+	cli::StringView string;
+	const char* path;
+	cli::Blob blob;
+	std::vector<int64_t> integers;
+	std::vector<double> numbers;
+	std::vector<const char*> strings;
+};
+
+struct cli_parser {
+	std::vector<SpecOption> spec;
+	// never resized once the options are bound to them
+	std::vector<Slot> slots;
+	std::unique_ptr<cli::Parser> parser;
+	std::vector<unsigned char> arguments;
+	std::string errors;
+};
+
+static bool isListType(cli_type type) {
+	return type == CLI_TYPE_INT64_LIST || type == CLI_TYPE_DOUBLE_LIST || type == CLI_TYPE_STRING_LIST;
+}
+
+// C++ exceptions must not reach the C caller, the entry points that allocate
+// catch them and report the failure through their return value instead.
+static int addOption(cli_spec* spec, const SpecOption& option) {
+	for(const SpecOption& other : spec->options) {
+		if(other.longName == option.longName || (option.shortName != 0 && other.shortName == option.shortName)) {
+			return -1;
+		}
+	}
+	try {
+		spec->options.push_back(option);
+	} catch(...) {
+		return -1;
+	}
+	return (int)spec->options.size() - 1;
+}
+
+cli_spec* cli_spec_new(void) {
+	try {
+		return new cli_spec();
+	} catch(...) {
+		return nullptr;
+	}
+}
+
+void cli_spec_free(cli_spec* spec) {
+	delete spec;
+}
+
+int cli_spec_add_option(cli_spec* spec, cli_type type, char short_name, const char* long_name, const char* description, int required, int fractional_digits) {
+	if(spec == nullptr || long_name == nullptr || type < CLI_TYPE_FLAG || type > CLI_TYPE_BASE64) {
+		return -1;
+	}
+	if(type == CLI_TYPE_DECIMAL && (fractional_digits < 0 || fractional_digits > 18)) {
+		return -1;
+	}
+	try {
+		return addOption(spec, SpecOption {type, false, short_name, long_name, description != nullptr ? description : "", required != 0, fractional_digits});
+	} catch(...) {
+		return -1;
+	}
+}
+
+int cli_spec_add_positional(cli_spec* spec, cli_type type, const char* name, const char* description, int required) {
+	if(spec == nullptr || name == nullptr || !(type == CLI_TYPE_INT64 || type == CLI_TYPE_DOUBLE || type == CLI_TYPE_STRING || isListType(type))) {
+		return -1;
+	}
+	try {
+		return addOption(spec, SpecOption {type, true, 0, name, description != nullptr ? description : "", required != 0, 0});
+	} catch(...) {
+		return -1;
+	}
+}
+
+static cli::Option bindOption(const SpecOption& option, Slot& slot) {
+	const char* name = option.longName.c_str();
+	const char* description = option.description.c_str();
+	if(option.positional) {
+		switch(option.type) {
+			case CLI_TYPE_INT64:
+				return cli::PositionalInt64(name, description, option.required, &slot.integer);
+			case CLI_TYPE_DOUBLE:
+				return cli::PositionalDouble(name, description, option.required, &slot.number);
+			case CLI_TYPE_INT64_LIST:
+				return cli::RemainingInt64(name, description, option.required, &slot.integers);
+			case CLI_TYPE_DOUBLE_LIST:
+				return cli::RemainingDouble(name, description, option.required, &slot.numbers);
+			case CLI_TYPE_STRING_LIST:
+				return cli::RemainingPaths(name, description, option.required, &slot.strings);
+			default:
+				return cli::PositionalPath(name, description, option.required, &slot.path);
+		}
+	}
+	switch(option.type) {
+		case CLI_TYPE_FLAG:
+			return cli::OptionFlag(option.shortName, name, description, &slot.flag);
+		case CLI_TYPE_FLAG_COUNT:
+			return cli::OptionFlagCount(option.shortName, name, description, &slot.count);
+		case CLI_TYPE_INT64:
+			return cli::OptionInt64(option.shortName, name, description, option.required, &slot.integer);
+		case CLI_TYPE_DOUBLE:
+			return cli::OptionDouble(option.shortName, name, description, option.required, &slot.number);
+		case CLI_TYPE_DECIMAL:
+			return cli::OptionDecimal(option.shortName, name, description, option.required, option.fractionalDigits, &slot.integer);
+		case CLI_TYPE_HEX:
+			return cli::OptionHex(option.shortName, name, description, option.required, &slot.blob);
+		case CLI_TYPE_BASE64:
+			return cli::OptionBase64(option.shortName, name, description, option.required, &slot.blob);
+		default:
+			return cli::OptionStringView(option.shortName, name, description, option.required, &slot.string);
+	}
+}
+
+cli_parser* cli_parser_new(const cli_spec* spec) {
+	if(spec == nullptr) {
+		return nullptr;
+	}
+	std::unique_ptr<cli_parser> parser;
+	try {
+		parser.reset(new cli_parser());
+		parser->spec = spec->options;
+		parser->slots.resize(parser->spec.size());
+		std::vector<cli::Option> options;
+		options.reserve(parser->spec.size());
+		for(size_t i = 0; i < parser->spec.size(); ++i) {
+			Slot& slot = parser->slots[i];
+			slot.flag = false;
+			slot.count = 0;
+			slot.integer = 0;
+			slot.number = 0;
+			slot.string = cli::StringView {nullptr, 0};
+			slot.path = nullptr;
+			slot.blob = cli::Blob {};
+			options.push_back(bindOption(parser->spec[i], slot));
+		}
+		parser->parser.reset(new cli::Parser(std::move(options)));
+	} catch(...) {
+		return nullptr;
+	}
+	return parser.release();
+}
+
+void cli_parser_free(cli_parser* parser) {
+	delete parser;
+}
+
+int cli_parser_find(const cli_parser* parser, const char* long_name) {
+	if(parser == nullptr || long_name == nullptr) {
+		return -1;
+	}
+	for(size_t i = 0; i < parser->spec.size(); ++i) {
+		if(parser->spec[i].longName == long_name) {
+			return (int)i;
+		}
+	}
+	return -1;
+}
+
+// Parses the arguments encoded in parser->arguments
+static int parseArguments(cli_parser* parser) {
+	parser->errors.clear();
+	parser->parser->reset();
+	parserErrors = &parser->errors;
+	bool valid = parser->parser->parseEncoded(parser->arguments.data(), parser->arguments.size());
+	parserErrors = nullptr;
+	return valid ? 1 : 0;
+}
+
+// Reports a parse interrupted by an exception, the values are left unset
+static int parseFailed(cli_parser* parser, const char* message) {
+	parserErrors = nullptr;
+	parser->parser->reset();
+	try {
+		parser->errors.assign(message);
+	} catch(...) {
+		parser->errors.clear();
+	}
+	return 0;
+}
+
+int cli_parse(cli_parser* parser, int argc, const char* const* argv) {
+	if(parser == nullptr || argc < 0 || (argc > 0 && argv == nullptr)) {
+		return 0;
+	}
+	try {
+		// a single copy of the arguments, the values point into it
+		parser->arguments.resize(cli::encodedArgumentsLength(argc, argv));
+		cli::encodeArguments(argc, argv, parser->arguments.data());
+		return parseArguments(parser);
+	} catch(const std::bad_alloc&) {
+		return parseFailed(parser, "error: out of memory\n");
+	} catch(...) {
+		return parseFailed(parser, "error: the arguments couldn't be parsed\n");
+	}
+}
+
+int cli_parse_encoded(cli_parser* parser, const unsigned char* data, size_t length) {
+	if(parser == nullptr || (length > 0 && data == nullptr)) {
+		return 0;
+	}
+	try {
+		parser->arguments.assign(data, data + length);
+		return parseArguments(parser);
+	} catch(const std::bad_alloc&) {
+		return parseFailed(parser, "error: out of memory\n");
+	} catch(...) {
+		return parseFailed(parser, "error: the arguments couldn't be parsed\n");
+	}
+}
+
+const char* cli_parser_errors(const cli_parser* parser) {
+	return parser != nullptr ? parser->errors.c_str() : "";
+}
+
+// Slot of an option of one of the given types, NULL for other options
+static const Slot* slotOf(const cli_parser* parser, int option, cli_type type, cli_type otherType = (cli_type)-1) {
+	if(parser == nullptr || option < 0 || (size_t)option >= parser->spec.size()) {
+		return nullptr;
+	}
+	cli_type optionType = parser->spec[option].type;
+	if(optionType != type && optionType != otherType) {
+		return nullptr;
+	}
+	return &parser->slots[option];
+}
+
+int cli_is_set(const cli_parser* parser, int option) {
+	if(parser == nullptr || option < 0 || (size_t)option >= parser->spec.size()) {
+		return 0;
+	}
+	return parser->parser->isSet((size_t)option) ? 1 : 0;
+}
+
+int cli_get_flag(const cli_parser* parser, int option) {
+	const Slot* slot = slotOf(parser, option, CLI_TYPE_FLAG);
+	return slot != nullptr && slot->flag ? 1 : 0;
+}
+
+int cli_get_count(const cli_parser* parser, int option) {
+	const Slot* slot = slotOf(parser, option, CLI_TYPE_FLAG_COUNT);
+	return slot != nullptr ? slot->count : 0;
+}
+
+int64_t cli_get_int64(const cli_parser* parser, int option) {
+	const Slot* slot = slotOf(parser, option, CLI_TYPE_INT64, CLI_TYPE_DECIMAL);
+	return slot != nullptr ? slot->integer : 0;
+}
+
+double cli_get_double(const cli_parser* parser, int option) {
+	const Slot* slot = slotOf(parser, option, CLI_TYPE_DOUBLE);
+	return slot != nullptr ? slot->number : 0;
+}
+
+cli_string cli_get_string(const cli_parser* parser, int option) {
+	cli_string value = {nullptr, 0};
+	const Slot* slot = slotOf(parser, option, CLI_TYPE_STRING);
+	if(slot == nullptr) {
+		return value;
+	}
+	if(parser->spec[option].positional) {
+		value.data = slot->path;
+		value.length = slot->path != nullptr ? strlen(slot->path) : 0;
+	} else {
+		value.data = slot->string.data;
+		value.length = slot->string.length;
+	}
+	return value;
+}
+
+cli_bytes cli_get_bytes(const cli_parser* parser, int option) {
+	cli_bytes value = {nullptr, 0};
+	const Slot* slot = slotOf(parser, option, CLI_TYPE_HEX, CLI_TYPE_BASE64);
+	if(slot != nullptr) {
+		value.data = slot->blob.data;
+		value.length = slot->blob.length;
+	}
+	return value;
+}
+
+const int64_t* cli_get_int64_list(const cli_parser* parser, int option, size_t* count) {
+	const Slot* slot = slotOf(parser, option, CLI_TYPE_INT64_LIST);
+	if(count != nullptr) *count = slot != nullptr ? slot->integers.size() : 0;
+	return slot != nullptr ? slot->integers.data() : nullptr;
+}
+
+const double* cli_get_double_list(const cli_parser* parser, int option, size_t* count) {
+	const Slot* slot = slotOf(parser, option, CLI_TYPE_DOUBLE_LIST);
+	if(count != nullptr) *count = slot != nullptr ? slot->numbers.size() : 0;
+	return slot != nullptr ? slot->numbers.data() : nullptr;
+}
+
+size_t cli_get_string_list_count(const cli_parser* parser, int option) {
+	const Slot* slot = slotOf(parser, option, CLI_TYPE_STRING_LIST);
+	return slot != nullptr ? slot->strings.size() : 0;
+}
+
+cli_string cli_get_string_list_item(const cli_parser* parser, int option, size_t index) {
+	cli_string value = {nullptr, 0};
+	const Slot* slot = slotOf(parser, option, CLI_TYPE_STRING_LIST);
+	if(slot != nullptr && index < slot->strings.size()) {
+		value.data = slot->strings[index];
+		value.length = strlen(value.data);
+	}
+	return value;
+}
+
+size_t cli_remaining_count(const cli_parser* parser) {
+	return parser != nullptr ? parser->parser->getRemainingArgs().size() : 0;
+}
+
+cli_string cli_remaining(const cli_parser* parser, size_t index) {
+	cli_string value = {nullptr, 0};
+	if(parser != nullptr && index < parser->parser->getRemainingArgs().size()) {
+		value.data = parser->parser->getRemainingArgs()[index];
+		value.length = strlen(value.data);
+	}
+	return value;
+}
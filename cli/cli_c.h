@@ -0,0 +1,120 @@
+/*
+C interface to the cli parser, for use from other languages through a
+foreign function interface (ctypes, cgo, Rust FFI...).
+
+A spec is built with cli_spec_add_option() and cli_spec_add_positional(),
+which return the index used to read the option's value.  A parser is
+created from a spec, and can be used for any number of parses.  Each parse
+copies the arguments once into memory owned by the parser.  String and
+bytes values are views into that memory, valid until the next parse or
+until the parser is freed.  No memory is allocated to read a value.
+No C++ exception crosses this interface, failures such as running out of
+memory are reported through the return values.
+
+	cli_spec* spec = cli_spec_new();
+	int jobs = cli_spec_add_option(spec, CLI_TYPE_INT64, 'j', "jobs", "parallel jobs", 0, 0);
+	int name = cli_spec_add_option(spec, CLI_TYPE_STRING, 'n', "name", "name", 1, 0);
+	cli_parser* parser = cli_parser_new(spec);
+	cli_spec_free(spec);
+
+	if(!cli_parse(parser, argc, argv)) {
+		fputs(cli_parser_errors(parser), stderr);
+	}
+	int64_t jobCount = cli_get_int64(parser, jobs);
+	cli_string nameValue = cli_get_string(parser, name);
+
+Functions taking an option index return a zero value for invalid indices or
+options of another type.
+*/
+
+#ifndef CLI_C_H
+#define CLI_C_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__GNUC__) || defined(__clang__)
+#define CLI_C_API __attribute__((visibility("default")))
+#else
+#define CLI_C_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct cli_spec cli_spec;
+typedef struct cli_parser cli_parser;
+
+typedef enum cli_type {
+	CLI_TYPE_FLAG = 0,
+	CLI_TYPE_FLAG_COUNT = 1,
+	CLI_TYPE_INT64 = 2,
+	CLI_TYPE_DOUBLE = 3,
+	CLI_TYPE_DECIMAL = 4,	/* int64 scaled by 10^fractional_digits */
+	CLI_TYPE_STRING = 5,
+	CLI_TYPE_HEX = 6,
+	CLI_TYPE_BASE64 = 7,
+	CLI_TYPE_INT64_LIST = 8,	/* positional only, every remaining argument */
+	CLI_TYPE_DOUBLE_LIST = 9,	/* positional only, every remaining argument */
+	CLI_TYPE_STRING_LIST = 10	/* positional only, every remaining argument */
+} cli_type;
+
+/* Views into memory owned by a parser */
+typedef struct cli_string {
+	const char* data;
+	size_t length;
+} cli_string;
+
+typedef struct cli_bytes {
+	const unsigned char* data;
+	size_t length;
+} cli_bytes;
+
+CLI_C_API cli_spec* cli_spec_new(void);
+CLI_C_API void cli_spec_free(cli_spec* spec);
+/* Returns the index of the option, -1 if the type isn't supported for options,
+   if the long or short name is already used by another option, or if memory
+   runs out.  fractional_digits is only used by CLI_TYPE_DECIMAL, which
+   supports 0 to 18 digits. */
+CLI_C_API int cli_spec_add_option(cli_spec* spec, cli_type type, char short_name, const char* long_name, const char* description, int required, int fractional_digits);
+/* Positional arguments are assigned in the order they're added.  Supports
+   CLI_TYPE_INT64, CLI_TYPE_DOUBLE, CLI_TYPE_STRING and the list types.
+   Returns -1 as cli_spec_add_option() does. */
+CLI_C_API int cli_spec_add_positional(cli_spec* spec, cli_type type, const char* name, const char* description, int required);
+
+/* The parser keeps its own copy of the spec.  NULL if memory runs out. */
+CLI_C_API cli_parser* cli_parser_new(const cli_spec* spec);
+CLI_C_API void cli_parser_free(cli_parser* parser);
+/* Index of the option with the given long name, -1 if there's none */
+CLI_C_API int cli_parser_find(const cli_parser* parser, const char* long_name);
+
+/* Parsing returns 1 on success and 0 on failure, with the error messages in
+   cli_parser_errors().  Values of the previous parse are cleared. */
+CLI_C_API int cli_parse(cli_parser* parser, int argc, const char* const* argv);
+/* Parses arguments encoded as with cli::encodeArguments() */
+CLI_C_API int cli_parse_encoded(cli_parser* parser, const unsigned char* data, size_t length);
+CLI_C_API const char* cli_parser_errors(const cli_parser* parser);
+
+CLI_C_API int cli_is_set(const cli_parser* parser, int option);
+CLI_C_API int cli_get_flag(const cli_parser* parser, int option);
+CLI_C_API int cli_get_count(const cli_parser* parser, int option);
+CLI_C_API int64_t cli_get_int64(const cli_parser* parser, int option);
+CLI_C_API double cli_get_double(const cli_parser* parser, int option);
+CLI_C_API cli_string cli_get_string(const cli_parser* parser, int option);
+CLI_C_API cli_bytes cli_get_bytes(const cli_parser* parser, int option);
+/* Lists are contiguous arrays owned by the parser */
+CLI_C_API const int64_t* cli_get_int64_list(const cli_parser* parser, int option, size_t* count);
+CLI_C_API const double* cli_get_double_list(const cli_parser* parser, int option, size_t* count);
+CLI_C_API size_t cli_get_string_list_count(const cli_parser* parser, int option);
+CLI_C_API cli_string cli_get_string_list_item(const cli_parser* parser, int option, size_t index);
+
+/* Positional arguments that aren't captured by a positional option */
+CLI_C_API size_t cli_remaining_count(const cli_parser* parser);
+CLI_C_API cli_string cli_remaining(const cli_parser* parser, size_t index);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CLI_C_H */
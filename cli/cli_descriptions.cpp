@@ -0,0 +1,91 @@
+// Compresses option descriptions into a table for Parser::setDescriptions()
+// or Parser::setDescriptionFile().  The input has one option per line, its
+// long name and its description separated by a tab.  With --array the table
+// is written as a C++ source defining a const array NAME, placed in a
+// section of its own, and its length NAME_length.
+//
+//	cli_descriptions [--array=NAME] DESCRIPTIONS OUTPUT
+
+#include <string>
+#define CLI_ENABLE_DESCRIPTIONS 1
+#include <cli.h>
+
+static bool readDescriptions(const char* path, std::vector<std::string>& names, std::vector<std::string>& descriptions) {
+	cli::MappedFile file;
+	if(!file.open(path)) {
+		fprintf(stderr, "error: can't read '%s'\n", path);
+		return false;
+	}
+	const char* cursor = file.data;
+	const char* end = file.data + file.length;
+	for(int line = 1; cursor < end; ++line) {
+		const char* lineEnd = (const char*)memchr(cursor, '\n', end - cursor);
+		if(lineEnd == nullptr) {
+			lineEnd = end;
+		}
+		if(lineEnd != cursor) {
+			const char* tab = (const char*)memchr(cursor, '\t', lineEnd - cursor);
+			if(tab == nullptr || tab == cursor) {
+				fprintf(stderr, "error: %s:%d: expected a long name, a tab and a description\n", path, line);
+				return false;
+			}
+			names.push_back(std::string(cursor, tab));
+			descriptions.push_back(std::string(tab + 1, lineEnd));
+		}
+		cursor = lineEnd + 1;
+	}
+	return true;
+}
+
+int main(int argc, const char* argv[]) {
+	const char* array = nullptr;
+	cli::Parser parser = {
+		cli::OptionString('a', "array", "write a C++ source defining this array", false, &array)
+	};
+	if(!parser.parse(argc, argv) || parser.getRemainingArgs().size() != 2) {
+		fprintf(stderr, "\nUsage: cli_descriptions [--array=NAME] DESCRIPTIONS OUTPUT\n\n");
+		parser.printOptionsUsage();
+		return 1;
+	}
+	const char* input = parser.getRemainingArgs()[0];
+	const char* output = parser.getRemainingArgs()[1];
+
+	std::vector<std::string> names;
+	std::vector<std::string> descriptions;
+	if(!readDescriptions(input, names, descriptions)) {
+		return 1;
+	}
+	std::vector<const char*> nameList;
+	std::vector<const char*> descriptionList;
+	size_t textLength = 0;
+	for(size_t i = 0; i < names.size(); ++i) {
+		nameList.push_back(names[i].c_str());
+		descriptionList.push_back(descriptions[i].c_str());
+		textLength += names[i].size() + descriptions[i].size() + 2;
+	}
+	std::vector<unsigned char> table;
+	cli::encodeDescriptions(nameList.data(), descriptionList.data(), names.size(), table);
+
+	FILE* out = fopen(output, array != nullptr ? "w" : "wb");
+	if(out == nullptr) {
+		fprintf(stderr, "error: can't write '%s'\n", output);
+		return 1;
+	}
+	if(array == nullptr) {
+		fwrite(table.data(), 1, table.size(), out);
+	} else {
+		fprintf(out, "// Generated by cli_descriptions from %s\n\n#include <stddef.h>\n\n", input);
+		fprintf(out, "extern const unsigned char %s[];\nextern const size_t %s_length;\n\n", array, array);
+		fprintf(out, "__attribute__((section(\".cli_descriptions\")))\nconst unsigned char %s[] = {", array);
+		for(size_t i = 0; i < table.size(); ++i) {
+			fprintf(out, "%s%u,", i % 16 == 0 ? "\n\t" : " ", table[i]);
+		}
+		fprintf(out, "\n};\n\nconst size_t %s_length = %zu;\n", array, table.size());
+	}
+	if(fclose(out) != 0) {
+		fprintf(stderr, "error: can't write '%s'\n", output);
+		return 1;
+	}
+	fprintf(stderr, "%zu descriptions, %zu bytes compressed to %zu\n", names.size(), textLength, table.size());
+	return 0;
+}
@@ -0,0 +1,194 @@
+/*
+Declarations of the options of the cli parser that don't need the C++
+standard library, for translation units that only declare options and
+parse with a LeanParser.  The implementation is compiled once into the
+coqui_cli library, or into the translation unit that includes cli.h with
+CLI_IMPLEMENTATION defined.  cli.h includes this header.
+
+	#include <cli_lean.h>
+
+	cli::Option options[] = {
+		cli::OptionString('i', "input-file", "input file", true, &inputFilename),
+		cli::OptionFlagCount('v', "verbose", "verbose logging", &verbosity)
+	};
+	cli::LeanParser parser(options);
+	if(!parser.parse(argc, argv)) {
+		parser.printOptionsUsage();
+	}
+*/
+
+#ifndef CLI_LEAN_H
+#define CLI_LEAN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace cli {
+
+// What happens when an option is given more than once
+enum class RepeatPolicy {
+	Default,	// use the Parser's policy
+	Error,
+	LastWins,
+	FirstWins,
+	Accumulate
+};
+
+struct Option {
+	enum class Type {
+		Flag,
+		FlagCount,
+		Int,
+		Float,
+		String,
+		Path,
+		PathExisting,
+		Decimal,
+		Hex,
+		Base64,
+		SecretFd,
+		Glob,
+		Regex,
+		Int64,
+		Double,
+		Int64List,
+		DoubleList,
+		PathList,
+		FilesFrom,
+		Shard,
+		StringView
+	};
+	Type type;
+	char shortName;
+	const char* longName;
+	const char* description;
+	bool isRequired;
+	
+	bool isSet;
+	void* valuePointer;
+	// Value used when an optional-value option is given without one, NULL if the value is mandatory
+	const char* implicitValue;
+	// Number of digits after the decimal point for Decimal options
+	int fractionalDigits;
+	// Accept @path to load the value from a file
+	bool valueFromFile;
+	// Filled by positional arguments instead of a named option
+	bool isPositional;
+	RepeatPolicy repeatPolicy;
+
+	bool takesValue() const {
+		return type != Option::Type::Flag && type != Option::Type::FlagCount;
+	}
+
+	bool requiresParameter() const {
+		return takesValue() && implicitValue == nullptr;
+	}
+
+	bool hasOptionalValue() const {
+		return takesValue() && implicitValue != nullptr;
+	}
+
+	bool isList() const {
+		return type == Option::Type::Int64List || type == Option::Type::DoubleList || type == Option::Type::PathList;
+	}
+
+	// Whether converting the value reads files, fds or the file system
+	bool hasSideEffects() const {
+		return valueFromFile || type == Option::Type::PathExisting || type == Option::Type::SecretFd ||
+			type == Option::Type::FilesFrom || type == Option::Type::Shard;
+	}
+
+	template<typename T> 
+	T& as() const {
+		return *static_cast<T*>(valuePointer);
+	}
+};
+
+// Slice of a string that isn't necessarily NUL-terminated
+struct StringView {
+	const char* data;
+	size_t length;
+};
+
+// Binary value of a Hex or Base64 option.  Set buffer and capacity to decode
+// into your own memory, otherwise the value is decoded into storage owned by
+// the Parser.  data and length describe the decoded value.
+struct Blob {
+	unsigned char* buffer;
+	size_t capacity;
+	const unsigned char* data;
+	size_t length;
+};
+
+// Value of a SecretFd option.  Set capacity to the maximum length of the
+// secret, 4096 bytes are allowed if it is 0.  The secret is read with a
+// single read() into locked memory owned by the Parser, which is zeroed when
+// the Parser is destroyed.  A trailing newline is not part of the value.
+struct Secret {
+	size_t capacity;
+	const char* data;
+	size_t length;
+};
+
+class Pattern;
+class FileList;
+class Parser;
+
+Option OptionFlag(char shortName, const char* longName, const char* description, bool* valuePointer);
+Option OptionFlagCount(char shortName, const char* longName, const char* description, int* valuePointer);
+Option OptionInt(char shortName, const char* longName, const char* description, bool required, int* valuePointer);
+Option OptionFloat(char shortName, const char* longName, const char* description, bool required, float* valuePointer);
+Option OptionInt64(char shortName, const char* longName, const char* description, bool required, int64_t* valuePointer);
+Option OptionDouble(char shortName, const char* longName, const char* description, bool required, double* valuePointer);
+Option OptionString(char shortName, const char* longName, const char* description, bool required, const char** valuePointer);
+Option OptionStringView(char shortName, const char* longName, const char* description, bool required, StringView* valuePointer);
+Option OptionPath(char shortName, const char* longName, const char* description, bool required, const char** valuePointer);
+Option OptionPathExisting(char shortName, const char* longName, const char* description, bool required, const char** valuePointer);
+Option OptionDecimal(char shortName, const char* longName, const char* description, bool required, int fractionalDigits, int64_t* valuePointer);
+Option OptionHex(char shortName, const char* longName, const char* description, bool required, Blob* valuePointer);
+Option OptionBase64(char shortName, const char* longName, const char* description, bool required, Blob* valuePointer);
+Option OptionSecretFd(char shortName, const char* longName, const char* description, bool required, Secret* valuePointer);
+Option OptionGlob(char shortName, const char* longName, const char* description, bool required, Pattern* valuePointer);
+Option OptionRegex(char shortName, const char* longName, const char* description, bool required, Pattern* valuePointer);
+Option OptionFilesFrom(char shortName, const char* longName, const char* description, bool required, FileList* valuePointer);
+Option OptionShard(char shortName, const char* longName, const char* description, bool required, FileList* valuePointer);
+Option PositionalInt64(const char* name, const char* description, bool required, int64_t* valuePointer);
+Option PositionalDouble(const char* name, const char* description, bool required, double* valuePointer);
+Option PositionalPath(const char* name, const char* description, bool required, const char** valuePointer);
+Option OptionalValue(Option option, const char* implicitValue);
+Option OnRepeat(Option option, RepeatPolicy policy);
+Option ValueFromFile(Option option);
+
+// Parser kept behind a pointer, so that the translation units using it
+// don't include the standard library.  The options are copied.
+class LeanParser {
+public:
+	LeanParser(const Option* options, size_t count);
+	template<size_t N>
+	explicit LeanParser(const Option (&options)[N]) : LeanParser(options, N) {}
+	LeanParser(const LeanParser&) = delete;
+	LeanParser& operator=(const LeanParser&) = delete;
+	~LeanParser();
+
+	bool parse(int argc, const char* argv[]);
+	// Restores the bound variables to their values when the LeanParser was created
+	void reset();
+	void printOptionsUsage();
+	// Whether the option at the given index of the options was given
+	bool isSet(size_t option) const;
+	// Positional arguments that aren't captured by a positional option
+	size_t remainingCount() const;
+	const char* remaining(size_t index) const;
+
+	// The underlying Parser, see cli.h
+	Parser& parser() {
+		return *impl;
+	}
+
+private:
+	Parser* impl;
+};
+
+}; // end namespace
+
+#endif // CLI_LEAN_H
@@ -0,0 +1,688 @@
+/*
+Validation server for cli::Parser specs, answering requests over a Unix
+domain socket.  Services written in other languages can validate command
+lines of a tool without spawning it.
+
+# Compiling
+	Include <cli_server.h> after <cli.h>, with the same CLI_DECLARATION and
+	CLI_IMPLEMENTATION macros.  The implementation must be compiled in the
+	same file as the implementation of cli.h.  Link with pthreads.
+
+	To return the error messages of invalid lines to clients, define
+	CLI_LOG_ERROR before including cli.h:
+
+		#define CLI_LOG_ERROR(fmt, ...) cli::serverLogError(fmt, ##__VA_ARGS__)
+
+# Usage
+	Each spec is registered under a name with a factory that builds a new
+	Parser, along with the variables it is bound to.  Each worker thread
+	builds its own instance of every spec, so parsers are never shared.
+	Since clients choose the values, specs with SecretFd, PathExisting,
+	FilesFrom, Shard or ValueFromFile() options are refused:
+
+		struct BuildSpec {
+			int jobs = 1;
+			cli::Parser parser = { cli::OptionInt('j', "jobs", "parallel jobs", false, &jobs) };
+		};
+
+		cli::ValidationServer server;
+		server.addSpec("build", [] {
+			auto spec = std::make_shared<BuildSpec>();
+			return std::shared_ptr<cli::Parser>(spec, &spec->parser);
+		});
+		server.listen("/run/build-validator.sock", 8);
+
+# Protocol
+	Integers are unsigned LEB128 varints unless noted.  A request is a
+	frame with a 4-byte little-endian length followed by:
+
+		spec name length, spec name
+		line count
+		for each line: encoded length, line encoded with cli::encodeArguments()
+
+	The response to each request is a frame with a 4-byte little-endian
+	length followed by:
+
+		line count
+		for each line: status byte, error message length, error messages
+
+	Status is 0 for valid lines, 1 for invalid lines, 2 for lines that can't
+	be decoded or are empty and 3 when the spec isn't known.  Requests are answered in
+	order.  The connection is closed after a request that can't be read.
+
+# Connections
+	A single thread accepts connections and receives requests, and hands
+	each complete request to a worker, so idle clients don't hold a
+	worker.  A connection is closed when a request isn't fully received, or
+	its response isn't read, within the timeout (10 seconds by default).
+	When the process runs out of file descriptors, accepting connections is
+	retried after a short pause.
+*/
+
+#if !defined(CLI_DECLARATION) && !defined(CLI_IMPLEMENTATION)
+#define CLI_DECLARATION 1
+#define CLI_IMPLEMENTATION 1
+#endif
+
+#include "cli.h"
+
+#if defined(CLI_DECLARATION) && !defined(_CLI_SERVER_DECLARATION_INCLUSION_GUARD)
+#define _CLI_SERVER_DECLARATION_INCLUSION_GUARD
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace cli {
+
+// Appends an error message to the response of the line validated by the calling thread
+void serverLogError(const char* fmt, ...);
+
+class ValidationServer {
+public:
+	typedef std::function<std::shared_ptr<Parser>()> ParserFactory;
+
+	enum class Status : uint8_t {
+		Valid,
+		Invalid,
+		Malformed,
+		UnknownSpec
+	};
+
+	ValidationServer() : listener(-1), wakeRead(-1), wakeWrite(-1), timeoutMilliseconds(10000), stopping(false) {}
+	~ValidationServer();
+	ValidationServer(const ValidationServer&) = delete;
+	ValidationServer& operator=(const ValidationServer&) = delete;
+
+	// Specs must be added before listen().  Lines are parsed in the server,
+	// so specs with options that read files, fds or the file system (see
+	// Option::hasSideEffects()) are refused.
+	bool addSpec(const char* name, ParserFactory factory);
+	// Time allowed to receive a request once its first byte arrived, and to
+	// send a response.  Must be set before listen().
+	void setTimeout(int milliseconds) {
+		timeoutMilliseconds = milliseconds;
+	}
+	// Binds the socket, replacing a stale one, and starts the workers
+	bool listen(const char* socketPath, size_t workers);
+	// Closes the socket and every connection, and waits for the workers
+	void stop();
+
+	// Largest request accepted
+	static const size_t maxFrameLength = 64 << 20;
+
+private:
+	struct Spec {
+		std::string name;
+		ParserFactory factory;
+	};
+
+	struct Connection {
+		int fd;
+		// bytes received and not handed to a worker yet
+		std::vector<unsigned char> input;
+		// set while a worker handles a request, responses are sent in order
+		bool busy;
+		// when the first byte of the pending request was received
+		std::chrono::steady_clock::time_point requestStart;
+	};
+
+	struct Request {
+		Connection* connection;
+		std::vector<unsigned char> frame;
+	};
+
+	std::vector<Spec> specs;
+	std::string path;
+	int listener;
+	// wakes the receiving thread when a worker is done or the server stops
+	int wakeRead;
+	int wakeWrite;
+	int timeoutMilliseconds;
+	std::atomic<bool> stopping;
+	std::thread receiver;
+	std::vector<std::thread> workers;
+	std::mutex connectionsMutex;
+	std::vector<std::unique_ptr<Connection>> connections;
+	// requests waiting for a worker, and connections whose request was handled
+	std::mutex requestsMutex;
+	std::condition_variable requestsReady;
+	std::deque<Request> requests;
+	std::vector<std::pair<Connection*, bool>> handled;
+
+	void receive();
+	void serve();
+	void wake();
+	bool receiveInput(Connection& connection);
+	bool dispatch(Connection& connection);
+	void closeConnection(Connection* connection);
+	bool handleRequest(const unsigned char* in, size_t length, std::vector<std::shared_ptr<Parser>>& parsers, std::vector<unsigned char>& response);
+};
+
+// Client of a ValidationServer
+class ValidationClient {
+public:
+	ValidationClient() : fd(-1) {}
+	~ValidationClient();
+	ValidationClient(const ValidationClient&) = delete;
+	ValidationClient& operator=(const ValidationClient&) = delete;
+
+	bool connect(const char* socketPath);
+	// Validates a batch of lines with a spec of the server.  Returns false if
+	// the request fails, else stores the status of each line and, if errors
+	// isn't NULL, their error messages.
+	bool validate(const char* spec, const CommandLine* lines, size_t count, ValidationServer::Status* statuses, std::vector<std::string>* errors = nullptr);
+
+private:
+	int fd;
+	std::vector<unsigned char> buffer;
+};
+
+}; // end namespace
+
+#endif // CLI_DECLARATION
+
+#if defined(CLI_IMPLEMENTATION) && !defined(_CLI_SERVER_IMPLEMENTATION_INCLUSION_GUARD)
+#define _CLI_SERVER_IMPLEMENTATION_INCLUSION_GUARD
+
+#include <stdarg.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace cli {
+
+// errors of the line being validated by each worker, NULL outside of the server
+static thread_local std::string* serverErrors = nullptr;
+
+void serverLogError(const char* fmt, ...) {
+	va_list args;
+	va_start(args, fmt);
+	if(serverErrors != nullptr) {
+		char message[512];
+		int length = vsnprintf(message, sizeof(message), fmt, args);
+		if(length > 0) {
+			serverErrors->append(message, (size_t)length < sizeof(message) ? (size_t)length : sizeof(message) - 1);
+		}
+	} else {
+		vfprintf(stderr, fmt, args);
+	}
+	va_end(args);
+}
+
+static bool readFully(int fd, unsigned char* data, size_t length) {
+	while(length > 0) {
+		ssize_t count = read(fd, data, length);
+		if(count < 0 && errno == EINTR) continue;
+		if(count <= 0) {
+			return false;
+		}
+		data += count;
+		length -= (size_t)count;
+	}
+	return true;
+}
+
+static bool writeFully(int fd, const unsigned char* data, size_t length) {
+	while(length > 0) {
+		ssize_t count = send(fd, data, length, MSG_NOSIGNAL);
+		if(count < 0 && errno == EINTR) continue;
+		if(count <= 0) {
+			return false;
+		}
+		data += count;
+		length -= (size_t)count;
+	}
+	return true;
+}
+
+// Reads a frame into buffer
+static bool readFrame(int fd, std::vector<unsigned char>& buffer) {
+	unsigned char header[4];
+	if(!readFully(fd, header, sizeof(header))) {
+		return false;
+	}
+	uint32_t length = (uint32_t)header[0] | (uint32_t)header[1] << 8 | (uint32_t)header[2] << 16 | (uint32_t)header[3] << 24;
+	if(length > ValidationServer::maxFrameLength) {
+		return false;
+	}
+	buffer.resize(length);
+	return readFully(fd, buffer.data(), length);
+}
+
+// Fills the length of a frame that starts with 4 reserved bytes and sends it
+static bool writeFrame(int fd, std::vector<unsigned char>& frame) {
+	uint32_t length = (uint32_t)(frame.size() - 4);
+	for(int i = 0; i < 4; ++i) {
+		frame[i] = (unsigned char)(length >> (8 * i));
+	}
+	return writeFully(fd, frame.data(), frame.size());
+}
+
+static void appendVarint(std::vector<unsigned char>& out, uint64_t value) {
+	unsigned char bytes[10];
+	out.insert(out.end(), bytes, writeVarint(value, bytes));
+}
+
+ValidationServer::~ValidationServer() {
+	stop();
+}
+
+bool ValidationServer::addSpec(const char* name, ParserFactory factory) {
+	std::shared_ptr<Parser> parser = factory();
+	if(!parser || parser->hasSideEffects()) {
+		CLI_LOG_ERROR("error: spec \"%s\" has options that read files, fds or the file system\n", name);
+		return false;
+	}
+	specs.push_back(Spec {name, std::move(factory)});
+	return true;
+}
+
+bool ValidationServer::listen(const char* socketPath, size_t workerCount) {
+	sockaddr_un address = {};
+	address.sun_family = AF_UNIX;
+	if(strlen(socketPath) >= sizeof(address.sun_path)) {
+		CLI_LOG_ERROR("error: socket path \"%s\" is too long\n", socketPath);
+		return false;
+	}
+	strcpy(address.sun_path, socketPath);
+	int wakePipe[2];
+	if(pipe2(wakePipe, O_CLOEXEC | O_NONBLOCK) != 0) {
+		CLI_LOG_ERROR("error: unable to create a pipe: %s\n", strerror(errno));
+		return false;
+	}
+	wakeRead = wakePipe[0];
+	wakeWrite = wakePipe[1];
+	// accepted until EAGAIN, connections themselves are blocking
+	listener = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+	if(listener < 0) {
+		CLI_LOG_ERROR("error: unable to create a socket: %s\n", strerror(errno));
+		close(wakeRead);
+		close(wakeWrite);
+		wakeRead = wakeWrite = -1;
+		return false;
+	}
+	unlink(socketPath);
+	if(bind(listener, (const sockaddr*)&address, sizeof(address)) != 0 || ::listen(listener, 128) != 0) {
+		CLI_LOG_ERROR("error: unable to listen on \"%s\": %s\n", socketPath, strerror(errno));
+		close(listener);
+		close(wakeRead);
+		close(wakeWrite);
+		listener = wakeRead = wakeWrite = -1;
+		return false;
+	}
+	path = socketPath;
+	stopping = false;
+	receiver = std::thread(&ValidationServer::receive, this);
+	for(size_t i = 0; i < (workerCount > 0 ? workerCount : 1); ++i) {
+		workers.emplace_back(&ValidationServer::serve, this);
+	}
+	return true;
+}
+
+void ValidationServer::stop() {
+	if(listener < 0) {
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(requestsMutex);
+		stopping = true;
+	}
+	requestsReady.notify_all();
+	wake();
+	{
+		// wakes the workers blocked sending a response
+		std::lock_guard<std::mutex> lock(connectionsMutex);
+		for(const std::unique_ptr<Connection>& connection : connections) {
+			shutdown(connection->fd, SHUT_RDWR);
+		}
+	}
+	receiver.join();
+	for(std::thread& worker : workers) {
+		worker.join();
+	}
+	workers.clear();
+	for(const std::unique_ptr<Connection>& connection : connections) {
+		close(connection->fd);
+	}
+	connections.clear();
+	requests.clear();
+	handled.clear();
+	close(listener);
+	close(wakeRead);
+	close(wakeWrite);
+	listener = wakeRead = wakeWrite = -1;
+	unlink(path.c_str());
+}
+
+void ValidationServer::wake() {
+	char byte = 0;
+	// a full pipe already wakes the receiving thread
+	while(write(wakeWrite, &byte, 1) < 0 && errno == EINTR) {}
+}
+
+void ValidationServer::receive() {
+	typedef std::chrono::steady_clock Clock;
+	std::vector<pollfd> polled;
+	std::vector<Connection*> polledConnections;
+	// accepting is paused after errors such as EMFILE
+	Clock::time_point acceptRetry = Clock::now();
+	while(!stopping) {
+		Clock::time_point now = Clock::now();
+		polled.clear();
+		polledConnections.clear();
+		polled.push_back(pollfd {wakeRead, POLLIN, 0});
+		bool accepting = now >= acceptRetry;
+		if(accepting) {
+			polled.push_back(pollfd {listener, POLLIN, 0});
+		}
+		// connections handled by a worker are polled again once it's done
+		Clock::time_point deadline = accepting ? Clock::time_point::max() : acceptRetry;
+		for(const std::unique_ptr<Connection>& connection : connections) {
+			if(connection->busy) continue;
+			polled.push_back(pollfd {connection->fd, POLLIN, 0});
+			polledConnections.push_back(connection.get());
+			if(!connection->input.empty()) {
+				deadline = std::min(deadline, connection->requestStart + std::chrono::milliseconds(timeoutMilliseconds));
+			}
+		}
+		int timeout = -1;
+		if(deadline != Clock::time_point::max()) {
+			timeout = (int)std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count() + 1;
+			if(timeout < 0) timeout = 0;
+		}
+		if(poll(polled.data(), polled.size(), timeout) < 0 && errno != EINTR) {
+			CLI_LOG_ERROR("error: unable to poll the connections: %s\n", strerror(errno));
+			return;
+		}
+		now = Clock::now();
+		size_t next = 0;
+
+		if(polled[next++].revents != 0) {
+			char bytes[64];
+			while(read(wakeRead, bytes, sizeof(bytes)) > 0) {}
+			std::vector<std::pair<Connection*, bool>> done;
+			{
+				std::lock_guard<std::mutex> lock(requestsMutex);
+				done.swap(handled);
+			}
+			for(const std::pair<Connection*, bool>& connection : done) {
+				connection.first->busy = false;
+				connection.first->requestStart = now;
+				if(!connection.second || !dispatch(*connection.first)) {
+					closeConnection(connection.first);
+				}
+			}
+		}
+
+		if(accepting && polled[next++].revents != 0) {
+			while(!stopping) {
+				int fd = accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+				if(fd < 0) {
+					if(errno == EINTR || errno == ECONNABORTED) continue;
+					if(errno != EAGAIN && errno != EWOULDBLOCK) {
+						// out of file descriptors or memory, the pending
+						// connections wait in the backlog meanwhile
+						CLI_LOG_ERROR("error: unable to accept a connection: %s\n", strerror(errno));
+						acceptRetry = now + std::chrono::milliseconds(100);
+					}
+					break;
+				}
+				timeval sendTimeout = { timeoutMilliseconds / 1000, (timeoutMilliseconds % 1000) * 1000 };
+				setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &sendTimeout, sizeof(sendTimeout));
+				std::unique_ptr<Connection> connection(new Connection());
+				connection->fd = fd;
+				connection->busy = false;
+				std::lock_guard<std::mutex> lock(connectionsMutex);
+				connections.push_back(std::move(connection));
+			}
+		}
+
+		for(size_t i = 0; i < polledConnections.size(); ++i) {
+			Connection* connection = polledConnections[i];
+			if(connection->busy) continue;
+			bool open = true;
+			if(polled[next + i].revents != 0) {
+				open = receiveInput(*connection) && dispatch(*connection);
+			}
+			// a request that isn't fully received in time closes its connection
+			if(open && !connection->busy && !connection->input.empty() && now - connection->requestStart >= std::chrono::milliseconds(timeoutMilliseconds)) {
+				open = false;
+			}
+			if(!open) {
+				closeConnection(connection);
+			}
+		}
+	}
+}
+
+// Appends the bytes available on a connection to its input, until it holds a
+// complete request.  False once the connection is closed.
+bool ValidationServer::receiveInput(Connection& connection) {
+	std::vector<unsigned char>& input = connection.input;
+	unsigned char bytes[16384];
+	for(;;) {
+		size_t wanted = sizeof(bytes);
+		if(input.size() >= 4) {
+			uint32_t length = (uint32_t)input[0] | (uint32_t)input[1] << 8 | (uint32_t)input[2] << 16 | (uint32_t)input[3] << 24;
+			if(length > maxFrameLength) {
+				return false;
+			}
+			if(input.size() - 4 >= length) {
+				return true;
+			}
+			wanted = std::min(wanted, 4 + (size_t)length - input.size());
+		}
+		ssize_t count = recv(connection.fd, bytes, wanted, MSG_DONTWAIT);
+		if(count < 0 && errno == EINTR) continue;
+		if(count < 0) {
+			return errno == EAGAIN || errno == EWOULDBLOCK;
+		}
+		if(count == 0) {
+			return false;
+		}
+		if(input.empty()) {
+			connection.requestStart = std::chrono::steady_clock::now();
+		}
+		input.insert(input.end(), bytes, bytes + count);
+	}
+}
+
+// Hands the first request of a connection to the workers once it's complete
+bool ValidationServer::dispatch(Connection& connection) {
+	std::vector<unsigned char>& input = connection.input;
+	if(connection.busy || input.size() < 4) {
+		return true;
+	}
+	uint32_t length = (uint32_t)input[0] | (uint32_t)input[1] << 8 | (uint32_t)input[2] << 16 | (uint32_t)input[3] << 24;
+	if(length > maxFrameLength) {
+		return false;
+	}
+	if(input.size() - 4 < length) {
+		return true;
+	}
+	Request request;
+	request.connection = &connection;
+	request.frame.assign(input.begin() + 4, input.begin() + 4 + length);
+	input.erase(input.begin(), input.begin() + 4 + length);
+	connection.busy = true;
+	{
+		std::lock_guard<std::mutex> lock(requestsMutex);
+		requests.push_back(std::move(request));
+	}
+	requestsReady.notify_one();
+	return true;
+}
+
+void ValidationServer::closeConnection(Connection* connection) {
+	// under the lock, so that stop() never shuts down a reused descriptor
+	std::lock_guard<std::mutex> lock(connectionsMutex);
+	close(connection->fd);
+	for(size_t i = 0; i < connections.size(); ++i) {
+		if(connections[i].get() == connection) {
+			connections.erase(connections.begin() + i);
+			break;
+		}
+	}
+}
+
+void ValidationServer::serve() {
+	// each worker has its own instance of every spec, built when first used
+	std::vector<std::shared_ptr<Parser>> parsers(specs.size());
+	std::vector<unsigned char> response;
+	for(;;) {
+		Request request;
+		{
+			std::unique_lock<std::mutex> lock(requestsMutex);
+			requestsReady.wait(lock, [this] { return stopping || !requests.empty(); });
+			if(stopping) {
+				return;
+			}
+			request = std::move(requests.front());
+			requests.pop_front();
+		}
+		response.assign(4, 0);
+		bool served = handleRequest(request.frame.data(), request.frame.size(), parsers, response) && writeFrame(request.connection->fd, response);
+		{
+			std::lock_guard<std::mutex> lock(requestsMutex);
+			handled.push_back(std::make_pair(request.connection, served));
+		}
+		wake();
+	}
+}
+
+bool ValidationServer::handleRequest(const unsigned char* in, size_t length, std::vector<std::shared_ptr<Parser>>& parsers, std::vector<unsigned char>& response) {
+	const unsigned char* end = in + length;
+	uint64_t nameLength = 0;
+	if(!readVarint(in, end, nameLength) || nameLength > (uint64_t)(end - in)) {
+		return false;
+	}
+	size_t spec = 0;
+	while(spec < specs.size() && !(specs[spec].name.size() == nameLength && memcmp(specs[spec].name.data(), in, nameLength) == 0)) {
+		++spec;
+	}
+	in += nameLength;
+	uint64_t count = 0;
+	if(!readVarint(in, end, count) || count > (uint64_t)(end - in)) {
+		return false;
+	}
+	if(spec < specs.size() && !parsers[spec]) {
+		parsers[spec] = specs[spec].factory();
+	}
+
+	std::string errors;
+	std::vector<StringView> args;
+	appendVarint(response, count);
+	for(uint64_t line = 0; line < count; ++line) {
+		uint64_t lineLength = 0;
+		if(!readVarint(in, end, lineLength) || lineLength > (uint64_t)(end - in)) {
+			return false;
+		}
+		Status status = Status::UnknownSpec;
+		errors.clear();
+		if(spec < specs.size()) {
+			Parser& parser = *parsers[spec];
+			parser.reset();
+			if(!decodeArguments(in, (size_t)lineLength, args)) {
+				status = Status::Malformed;
+			} else if(args.empty()) {
+				// a command line has at least the program name
+				status = Status::Malformed;
+				errors = "error: empty command line\n";
+			} else {
+				serverErrors = &errors;
+				status = parser.parse(args.data(), args.size()) ? Status::Valid : Status::Invalid;
+				serverErrors = nullptr;
+			}
+		}
+		in += lineLength;
+		response.push_back((unsigned char)status);
+		appendVarint(response, errors.size());
+		response.insert(response.end(), errors.begin(), errors.end());
+	}
+	return in == end;
+}
+
+ValidationClient::~ValidationClient() {
+	if(fd >= 0) {
+		close(fd);
+	}
+}
+
+bool ValidationClient::connect(const char* socketPath) {
+	sockaddr_un address = {};
+	address.sun_family = AF_UNIX;
+	if(strlen(socketPath) >= sizeof(address.sun_path)) {
+		return false;
+	}
+	strcpy(address.sun_path, socketPath);
+	if(fd >= 0) {
+		close(fd);
+	}
+	fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if(fd < 0) {
+		return false;
+	}
+	if(::connect(fd, (const sockaddr*)&address, sizeof(address)) != 0) {
+		close(fd);
+		fd = -1;
+		return false;
+	}
+	return true;
+}
+
+bool ValidationClient::validate(const char* spec, const CommandLine* lines, size_t count, ValidationServer::Status* statuses, std::vector<std::string>* errors) {
+	buffer.assign(4, 0);
+	size_t nameLength = strlen(spec);
+	appendVarint(buffer, nameLength);
+	buffer.insert(buffer.end(), spec, spec + nameLength);
+	appendVarint(buffer, count);
+	for(size_t i = 0; i < count; ++i) {
+		size_t lineLength = encodedArgumentsLength(lines[i].argc, lines[i].argv);
+		appendVarint(buffer, lineLength);
+		size_t offset = buffer.size();
+		buffer.resize(offset + lineLength);
+		encodeArguments(lines[i].argc, lines[i].argv, buffer.data() + offset);
+	}
+	if(fd < 0 || !writeFrame(fd, buffer) || !readFrame(fd, buffer)) {
+		return false;
+	}
+
+	const unsigned char* in = buffer.data();
+	const unsigned char* end = in + buffer.size();
+	uint64_t responseCount = 0;
+	if(!readVarint(in, end, responseCount) || responseCount != count) {
+		return false;
+	}
+	if(errors != nullptr) {
+		errors->assign(count, std::string());
+	}
+	for(size_t i = 0; i < count; ++i) {
+		uint64_t messageLength = 0;
+		if(in == end) {
+			return false;
+		}
+		statuses[i] = (ValidationServer::Status)*in++;
+		if(!readVarint(in, end, messageLength) || messageLength > (uint64_t)(end - in)) {
+			return false;
+		}
+		if(errors != nullptr) {
+			(*errors)[i].assign((const char*)in, (size_t)messageLength);
+		}
+		in += messageLength;
+	}
+	return true;
+}
+
+}; // end namespace
+
+#endif // CLI_IMPLEMENTATION
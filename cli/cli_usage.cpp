@@ -0,0 +1,96 @@
+// Reports how often the options of each spec were used, from the usage
+// segments written by parsers when CLI_USAGE_DIR is set.  Segments of the
+// same spec, e.g. collected from several machines, are added together.
+//
+//	cli_usage [--unused] SEGMENT_OR_DIRECTORY...
+
+#include <dirent.h>
+#include <algorithm>
+#include <map>
+#include <string>
+#define CLI_ENABLE_USAGE_COUNTERS 1
+#include <cli.h>
+
+struct SpecUsage {
+	size_t segments = 0;
+	uint64_t parses = 0;
+	std::vector<std::string> names;
+	std::vector<uint64_t> counts;
+};
+
+static bool addSegment(const std::string& path, std::map<uint64_t, SpecUsage>& specs) {
+	cli::UsageSegment segment;
+	if(!segment.open(path.c_str())) {
+		fprintf(stderr, "error: '%s' isn't a usage segment\n", path.c_str());
+		return false;
+	}
+	SpecUsage& usage = specs[segment.fingerprint()];
+	if(usage.segments == 0) {
+		for(size_t i = 0; i < segment.optionCount(); ++i) {
+			usage.names.push_back(segment.name(i));
+		}
+		usage.counts.assign(segment.optionCount(), 0);
+	}
+	// segments of the same spec have the same options
+	bool matches = segment.optionCount() == usage.names.size();
+	for(size_t i = 0; matches && i < segment.optionCount(); ++i) {
+		matches = usage.names[i] == segment.name(i);
+	}
+	if(!matches) {
+		fprintf(stderr, "error: the options of '%s' don't match other segments of spec %016llx\n", path.c_str(), (unsigned long long)segment.fingerprint());
+		return false;
+	}
+	++usage.segments;
+	usage.parses += segment.parses();
+	for(size_t i = 0; i < segment.optionCount(); ++i) {
+		usage.counts[i] += segment.count(i);
+	}
+	return true;
+}
+
+int main(int argc, const char* argv[]) {
+	bool unused = false;
+	cli::Parser parser = {
+		cli::OptionFlag('u', "unused", "only list options that were never used", &unused)
+	};
+	if(!parser.parse(argc, argv) || parser.getRemainingArgs().empty()) {
+		fprintf(stderr, "\nUsage: cli_usage [--unused] SEGMENT_OR_DIRECTORY...\n\n");
+		parser.printOptionsUsage();
+		return 1;
+	}
+
+	std::map<uint64_t, SpecUsage> specs;
+	bool valid = true;
+	for(const char* path : parser.getRemainingArgs()) {
+		DIR* directory = opendir(path);
+		if(directory == nullptr) {
+			valid = addSegment(path, specs) && valid;
+			continue;
+		}
+		while(dirent* entry = readdir(directory)) {
+			std::string name = entry->d_name;
+			if(name.size() > 6 && name.compare(name.size() - 6, 6, ".usage") == 0) {
+				valid = addSegment(std::string(path) + "/" + name, specs) && valid;
+			}
+		}
+		closedir(directory);
+	}
+
+	for(const auto& spec : specs) {
+		const SpecUsage& usage = spec.second;
+		printf("spec %016llx: %zu segment%s, %llu parses\n", (unsigned long long)spec.first, usage.segments, usage.segments > 1 ? "s" : "", (unsigned long long)usage.parses);
+		std::vector<size_t> order(usage.names.size());
+		for(size_t i = 0; i < order.size(); ++i) {
+			order[i] = i;
+		}
+		std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+			return usage.counts[a] > usage.counts[b];
+		});
+		for(size_t i : order) {
+			if(!unused || usage.counts[i] == 0) {
+				printf("%12llu  %s\n", (unsigned long long)usage.counts[i], usage.names[i].c_str());
+			}
+		}
+	}
+	return valid ? 0 : 1;
+}
@@ -0,0 +1,139 @@
+#include "support/test_base.h"
+
+#include <string.h>
+
+#include "cli_c.h"
+
+static bool equals(cli_string value, const char* expected) {
+	return value.length == strlen(expected) && memcmp(value.data, expected, value.length) == 0;
+}
+
+TEST_CASE("C interface", "") {
+	cli_spec* spec = cli_spec_new();
+	int verbose = cli_spec_add_option(spec, CLI_TYPE_FLAG_COUNT, 'v', "verbose", "more output", 0, 0);
+	int dryRun = cli_spec_add_option(spec, CLI_TYPE_FLAG, 'n', "dry-run", "don't build", 0, 0);
+	int jobs = cli_spec_add_option(spec, CLI_TYPE_INT64, 'j', "jobs", "parallel jobs", 0, 0);
+	int ratio = cli_spec_add_option(spec, CLI_TYPE_DOUBLE, 'r', "ratio", "ratio", 0, 0);
+	int price = cli_spec_add_option(spec, CLI_TYPE_DECIMAL, 0, "price", "price", 0, 2);
+	int name = cli_spec_add_option(spec, CLI_TYPE_STRING, 't', "target", "target", 1, 0);
+	int key = cli_spec_add_option(spec, CLI_TYPE_HEX, 0, "key", "key", 0, 0);
+	int input = cli_spec_add_positional(spec, CLI_TYPE_STRING, "input", "input file", 1);
+	int sizes = cli_spec_add_positional(spec, CLI_TYPE_INT64_LIST, "sizes", "sizes", 0);
+	REQUIRE(cli_spec_add_option(spec, CLI_TYPE_STRING_LIST, 0, "list", "", 0, 0) == -1);
+	REQUIRE(cli_spec_add_positional(spec, CLI_TYPE_HEX, "hex", "", 0) == -1);
+
+	cli_parser* parser = cli_parser_new(spec);
+	cli_spec_free(spec);
+	REQUIRE(parser != NULL);
+	REQUIRE(cli_parser_find(parser, "target") == name);
+	REQUIRE(cli_parser_find(parser, "missing") == -1);
+
+	SECTION("Values") {
+		char target[] = "release";
+		const char* argv[] = {"build", "-vv", "--jobs=8", "-r", "0.5", "--price", "12.34", "-t", target, "--key", "c0ffee", "in.txt", "1", "2", "3"};
+		REQUIRE(cli_parse(parser, 15, argv) == 1);
+		REQUIRE(strlen(cli_parser_errors(parser)) == 0);
+		REQUIRE(cli_get_count(parser, verbose) == 2);
+		REQUIRE(cli_get_flag(parser, dryRun) == 0);
+		REQUIRE(cli_is_set(parser, dryRun) == 0);
+		REQUIRE(cli_is_set(parser, jobs) == 1);
+		REQUIRE(cli_get_int64(parser, jobs) == 8);
+		REQUIRE(cli_get_double(parser, ratio) == 0.5);
+		REQUIRE(cli_get_int64(parser, price) == 1234);
+
+		// values point into the parser's copy of the arguments
+		cli_string targetValue = cli_get_string(parser, name);
+		REQUIRE(equals(targetValue, "release"));
+		REQUIRE(targetValue.data != target);
+		target[0] = 'X';
+		REQUIRE(equals(cli_get_string(parser, name), "release"));
+
+		cli_bytes keyValue = cli_get_bytes(parser, key);
+		REQUIRE(keyValue.length == 3);
+		REQUIRE(keyValue.data[0] == 0xc0);
+		REQUIRE(keyValue.data[2] == 0xee);
+		REQUIRE(equals(cli_get_string(parser, input), "in.txt"));
+
+		size_t count = 0;
+		const int64_t* values = cli_get_int64_list(parser, sizes, &count);
+		REQUIRE(count == 3);
+		REQUIRE(values[0] == 1);
+		REQUIRE(values[2] == 3);
+
+		// wrong type or index
+		REQUIRE(cli_get_int64(parser, name) == 0);
+		REQUIRE(cli_get_string(parser, jobs).data == NULL);
+		REQUIRE(cli_get_flag(parser, 100) == 0);
+		REQUIRE(cli_get_double_list(parser, sizes, &count) == NULL);
+		REQUIRE(count == 0);
+	}
+
+	SECTION("Reparsing clears the previous values") {
+		const char* first[] = {"build", "-v", "-n", "-t", "a", "in", "4"};
+		REQUIRE(cli_parse(parser, 7, first) == 1);
+		const char* second[] = {"build", "-t", "b", "in"};
+		REQUIRE(cli_parse(parser, 4, second) == 1);
+		REQUIRE(cli_get_count(parser, verbose) == 0);
+		REQUIRE(cli_get_flag(parser, dryRun) == 0);
+		REQUIRE(equals(cli_get_string(parser, name), "b"));
+		size_t count = 1;
+		cli_get_int64_list(parser, sizes, &count);
+		REQUIRE(count == 0);
+	}
+
+	SECTION("Errors") {
+		const char* argv[] = {"build", "--jobs=x", "in"};
+		REQUIRE(cli_parse(parser, 3, argv) == 0);
+		const char* errors = cli_parser_errors(parser);
+		REQUIRE(strstr(errors, "jobs") != NULL);
+
+		const char* valid[] = {"build", "-t", "a", "in"};
+		REQUIRE(cli_parse(parser, 4, valid) == 1);
+		REQUIRE(strlen(cli_parser_errors(parser)) == 0);
+
+		const unsigned char truncated[] = {3, 'a'};
+		REQUIRE(cli_parse_encoded(parser, truncated, sizeof(truncated)) == 0);
+		REQUIRE(strlen(cli_parser_errors(parser)) > 0);
+	}
+
+	cli_parser_free(parser);
+}
+
+TEST_CASE("C interface spec errors", "") {
+	cli_spec* spec = cli_spec_new();
+	REQUIRE(cli_spec_add_option(spec, CLI_TYPE_INT64, 'j', "jobs", "parallel jobs", 0, 0) == 0);
+	REQUIRE(cli_spec_add_option(spec, CLI_TYPE_INT64, 0, "jobs", "again", 0, 0) == -1);
+	REQUIRE(cli_spec_add_option(spec, CLI_TYPE_FLAG, 'j', "jump", "same short name", 0, 0) == -1);
+	REQUIRE(cli_spec_add_positional(spec, CLI_TYPE_STRING, "jobs", "positional", 0) == -1);
+	REQUIRE(cli_spec_add_option(spec, CLI_TYPE_DECIMAL, 0, "price", "price", 0, 19) == -1);
+	REQUIRE(cli_spec_add_option(spec, CLI_TYPE_DECIMAL, 0, "price", "price", 0, -1) == -1);
+	REQUIRE(cli_spec_add_option(spec, CLI_TYPE_DECIMAL, 0, "price", "price", 0, 18) == 1);
+	// options without a short name don't clash with each other
+	REQUIRE(cli_spec_add_option(spec, CLI_TYPE_FLAG, 0, "quiet", "less output", 0, 0) == 2);
+	cli_spec_free(spec);
+}
+
+TEST_CASE("C interface string lists", "") {
+	cli_spec* spec = cli_spec_new();
+	int files = cli_spec_add_positional(spec, CLI_TYPE_STRING_LIST, "files", "files", 1);
+	cli_parser* parser = cli_parser_new(spec);
+	cli_spec_free(spec);
+
+	const char* argv[] = {"cat", "a.txt", "bb.txt"};
+	REQUIRE(cli_parse(parser, 3, argv) == 1);
+	REQUIRE(cli_get_string_list_count(parser, files) == 2);
+	REQUIRE(equals(cli_get_string_list_item(parser, files, 1), "bb.txt"));
+	REQUIRE(cli_get_string_list_item(parser, files, 2).data == NULL);
+	REQUIRE(cli_remaining_count(parser) == 0);
+
+	const char* empty[] = {"cat"};
+	REQUIRE(cli_parse(parser, 1, empty) == 0);
+
+	// command lines without even a program name are parsed like empty ones
+	REQUIRE(cli_parse(parser, 0, NULL) == 0);
+	REQUIRE(strlen(cli_parser_errors(parser)) > 0);
+	REQUIRE(cli_parse_encoded(parser, (const unsigned char*)"\x00", 1) == 0);
+	REQUIRE(strlen(cli_parser_errors(parser)) > 0);
+	REQUIRE(cli_get_string_list_count(parser, files) == 0);
+	cli_parser_free(parser);
+}
@@ -0,0 +1,43 @@
+// Included first, to check that it doesn't need the standard library
+#include "cli_lean.h"
+#if defined(__GLIBCXX__) || defined(_LIBCPP_VERSION)
+#error "cli_lean.h includes the C++ standard library"
+#endif
+
+#include "support/test_base.h"
+
+#include "cli.h"
+
+TEST_CASE("Lean parser", "") {
+	int jobs = 1;
+	const char* target = nullptr;
+	int verbosity = 0;
+	cli::Option options[] = {
+		cli::OptionInt('j', "jobs", "parallel jobs", false, &jobs),
+		cli::OptionString('t', "target", "target", true, &target),
+		cli::OptionFlagCount('v', "verbose", "verbose logging", &verbosity)
+	};
+	cli::LeanParser parser(options);
+
+	const char* argv[] = { "tool", "-vv", "--jobs=4", "-t", "all", "extra" };
+	REQUIRE(parser.parse(6, argv));
+	REQUIRE(jobs == 4);
+	REQUIRE(strcmp(target, "all") == 0);
+	REQUIRE(verbosity == 2);
+	REQUIRE(parser.isSet(0));
+	REQUIRE(parser.remainingCount() == 1);
+	REQUIRE(strcmp(parser.remaining(0), "extra") == 0);
+	REQUIRE(parser.remaining(1) == nullptr);
+
+	parser.reset();
+	REQUIRE(verbosity == 0);
+	REQUIRE(!parser.isSet(0));
+	const char* missing[] = { "tool", "-j", "2" };
+	REQUIRE(!parser.parse(3, missing));
+
+	// the full API is still available through cli.h
+	parser.reset();
+	const char* valid[] = { "tool", "-t", "lib" };
+	REQUIRE(parser.parser().parse(3, valid));
+	REQUIRE(parser.parser().fingerprint() != 0);
+}
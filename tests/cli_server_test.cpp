@@ -0,0 +1,144 @@
+#include "support/test_base.h"
+
+#include <memory>
+
+#define CLI_LOG_ERROR(fmt, ...) cli::serverLogError(fmt, ##__VA_ARGS__)
+
+#define CLI_DECLARATION
+#include "cli.h"
+#include "cli_server.h"
+
+#define CLI_IMPLEMENTATION
+#include "cli.h"
+#include "cli_server.h"
+
+struct BuildSpec {
+	int jobs = 1;
+	const char* target = NULL;
+	cli::Parser parser = {
+		cli::OptionInt('j', "jobs", "parallel jobs", false, &jobs),
+		cli::OptionString('t', "target", "target to build", true, &target)
+	};
+};
+
+TEST_CASE("Validation server", "") {
+	const char* socketPath = "cli_server_test.sock";
+	cli::ValidationServer server;
+	server.addSpec("build", [] {
+		auto spec = std::make_shared<BuildSpec>();
+		return std::shared_ptr<cli::Parser>(spec, &spec->parser);
+	});
+	REQUIRE(server.listen(socketPath, 4));
+
+	const char* valid[] = { "build", "-j", "8", "--target=all" };
+	const char* invalidJobs[] = { "build", "-j", "many", "--target=all" };
+	const char* missingTarget[] = { "build", "-j", "2" };
+	cli::CommandLine lines[] = { {4, valid}, {4, invalidJobs}, {3, missingTarget}, {4, valid} };
+	cli::ValidationServer::Status statuses[4];
+	std::vector<std::string> errors;
+
+	// several clients are served concurrently by the workers
+	std::vector<std::thread> clients;
+	std::atomic<int> validBatches(0);
+	for(int c = 0; c < 4; ++c) {
+		clients.emplace_back([&] {
+			cli::ValidationClient client;
+			if(!client.connect(socketPath)) return;
+			bool batchValid = true;
+			for(int i = 0; i < 100; ++i) {
+				cli::ValidationServer::Status clientStatuses[4];
+				batchValid &= client.validate("build", lines, 4, clientStatuses);
+				batchValid &= clientStatuses[0] == cli::ValidationServer::Status::Valid;
+				batchValid &= clientStatuses[1] == cli::ValidationServer::Status::Invalid;
+			}
+			validBatches += batchValid ? 1 : 0;
+		});
+	}
+	for(std::thread& client : clients) {
+		client.join();
+	}
+	REQUIRE(validBatches == 4);
+
+	cli::ValidationClient client;
+	REQUIRE(client.connect(socketPath));
+	REQUIRE(client.validate("build", lines, 4, statuses, &errors));
+	REQUIRE(statuses[0] == cli::ValidationServer::Status::Valid);
+	REQUIRE(statuses[1] == cli::ValidationServer::Status::Invalid);
+	REQUIRE(statuses[2] == cli::ValidationServer::Status::Invalid);
+	REQUIRE(statuses[3] == cli::ValidationServer::Status::Valid);
+	REQUIRE(errors[0].empty());
+	REQUIRE(errors[1] == "error: invalid integer value \"many\" specified for option -j/--jobs\n");
+	REQUIRE(errors[2] == "error: option -t/--target is required\n");
+
+	// lines without even a program name are rejected before parsing
+	cli::CommandLine empty[] = { {0, nullptr}, {4, valid} };
+	REQUIRE(client.validate("build", empty, 2, statuses, &errors));
+	REQUIRE(statuses[0] == cli::ValidationServer::Status::Malformed);
+	REQUIRE(statuses[1] == cli::ValidationServer::Status::Valid);
+	REQUIRE(errors[0] == "error: empty command line\n");
+
+	REQUIRE(client.validate("deploy", lines, 1, statuses));
+	REQUIRE(statuses[0] == cli::ValidationServer::Status::UnknownSpec);
+
+	// options that would read the server's files or fds are refused
+	REQUIRE(!server.addSpec("secret", [] {
+		static cli::Secret secret = {};
+		return std::make_shared<cli::Parser>(std::initializer_list<cli::Option> {
+			cli::OptionSecretFd('s', "secret-fd", "secret", false, &secret)
+		});
+	}));
+	REQUIRE(!server.addSpec("config", [] {
+		static const char* config = nullptr;
+		return std::make_shared<cli::Parser>(std::initializer_list<cli::Option> {
+			cli::ValueFromFile(cli::OptionString('c', "config", "config", false, &config))
+		});
+	}));
+
+	server.stop();
+	REQUIRE(!client.validate("build", lines, 1, statuses));
+	REQUIRE(!client.connect(socketPath));
+}
+
+TEST_CASE("Validation server connections", "") {
+	const char* socketPath = "cli_server_connections_test.sock";
+	cli::ValidationServer server;
+	server.addSpec("build", [] {
+		auto spec = std::make_shared<BuildSpec>();
+		return std::shared_ptr<cli::Parser>(spec, &spec->parser);
+	});
+	server.setTimeout(200);
+	REQUIRE(server.listen(socketPath, 2));
+
+	// a request that stops halfway doesn't hold a worker
+	sockaddr_un address = {};
+	address.sun_family = AF_UNIX;
+	strcpy(address.sun_path, socketPath);
+	int stalled = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	REQUIRE(stalled >= 0);
+	REQUIRE(connect(stalled, (const sockaddr*)&address, sizeof(address)) == 0);
+	const unsigned char partial[] = { 100, 0, 0, 0, 5 };
+	REQUIRE(send(stalled, partial, sizeof(partial), MSG_NOSIGNAL) == (ssize_t)sizeof(partial));
+
+	// more persistent clients than workers are all served
+	const char* valid[] = { "build", "--target=all" };
+	cli::CommandLine lines[] = { {2, valid} };
+	std::vector<std::unique_ptr<cli::ValidationClient>> clients;
+	for(int c = 0; c < 6; ++c) {
+		clients.emplace_back(new cli::ValidationClient());
+		REQUIRE(clients.back()->connect(socketPath));
+	}
+	for(int i = 0; i < 3; ++i) {
+		for(std::unique_ptr<cli::ValidationClient>& client : clients) {
+			cli::ValidationServer::Status status;
+			REQUIRE(client->validate("build", lines, 1, &status));
+			REQUIRE(status == cli::ValidationServer::Status::Valid);
+		}
+	}
+
+	// and is closed once the timeout expires
+	unsigned char byte;
+	REQUIRE(recv(stalled, &byte, 1, 0) == 0);
+	close(stalled);
+
+	server.stop();
+}
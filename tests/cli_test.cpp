@@ -1,11 +1,37 @@
 #include "support/test_base.h"
 
+#include <unistd.h>
+#include <sys/wait.h>
+
 #define CLI_DECLARATION
 #include "cli.h"
 
 #define CLI_IMPLEMENTATION
+#define CLI_ENABLE_ALL
 #include "cli.h"
 
+// Runs body and returns what it wrote to stderr
+template<typename Body>
+static std::string capturedStderr(Body body) {
+	fflush(stderr);
+	FILE* capture = tmpfile();
+	int saved = dup(STDERR_FILENO);
+	dup2(fileno(capture), STDERR_FILENO);
+	body();
+	fflush(stderr);
+	dup2(saved, STDERR_FILENO);
+	close(saved);
+	std::string text;
+	rewind(capture);
+	char buffer[512];
+	size_t count;
+	while((count = fread(buffer, 1, sizeof(buffer), capture)) > 0) {
+		text.append(buffer, count);
+	}
+	fclose(capture);
+	return text;
+}
+
 TEST_CASE("Short option string parameter", "") {
 	const char* fileName = nullptr;
 
@@ -163,12 +189,12 @@ TEST_CASE("Path validation", "") {
 	};
 
 	const char* argv[] {
-		"testExe", "-S", "../CmakeLists.txt"
+		"testExe", "-S", "../CMakeLists.txt"
 	};
 
 	REQUIRE(parser.parse(3, argv));
 	REQUIRE(parser.validatePathOptions());
-	REQUIRE(strcmp(fileName, "../CmakeLists.txt") == 0);
+	REQUIRE(strcmp(fileName, "../CMakeLists.txt") == 0);
 }
 
 TEST_CASE("Remaining args", "") {
@@ -188,4 +214,1468 @@ TEST_CASE("Remaining args", "") {
 	auto files = parser.getRemainingArgs();
 	REQUIRE(files.size() == 1);
 	REQUIRE(strcmp(files[0], "somefile") == 0);
-}
\ No newline at end of file
+}
+
+TEST_CASE("Long option attached value", "") {
+	int intOption = 0;
+	const char* stringOption = NULL;
+	bool flagOption = false;
+
+	cli::Parser parser = {
+		cli::OptionInt('I', "int", "some int", false, &intOption),
+		cli::OptionString('S', "string", "some string", false, &stringOption),
+		cli::OptionFlag('D', "debug", "some flag", &flagOption)
+	};
+
+	const char* argv[] = {
+		"testExe", "--int=42", "--string=a=b", "somefile"
+	};
+
+	REQUIRE(parser.parse(4, argv));
+	REQUIRE(intOption == 42);
+	REQUIRE(strcmp(stringOption, "a=b") == 0);
+	REQUIRE(parser.getRemainingArgs().size() == 1);
+
+	cli::Parser flagParser = {
+		cli::OptionFlag('D', "debug", "some flag", &flagOption)
+	};
+	const char* flagArgv[] = {
+		"testExe", "--debug=yes"
+	};
+	REQUIRE(!flagParser.parse(2, flagArgv));
+}
+
+TEST_CASE("Optional value options", "") {
+	const char* color = "never";
+	int logLevel = 0;
+	int verbosity = 0;
+
+	cli::Parser parser = {
+		cli::OptionalValue(cli::OptionString('c', "color", "colorize output", false, &color), "auto"),
+		cli::OptionalValue(cli::OptionInt('l', "log", "log level", false, &logLevel), "1"),
+		cli::OptionFlagCount('v', "verbose", "verbosity", &verbosity)
+	};
+	parser.printOptionsUsage();
+
+	const char* argv[] = {
+		"testExe", "--color", "always", "--log=3"
+	};
+
+	REQUIRE(parser.parse(4, argv));
+	REQUIRE(strcmp(color, "auto") == 0);
+	REQUIRE(logLevel == 3);
+	auto remaining = parser.getRemainingArgs();
+	REQUIRE(remaining.size() == 1);
+	REQUIRE(strcmp(remaining[0], "always") == 0);
+}
+
+TEST_CASE("Optional value short options", "") {
+	const char* color = "never";
+	int logLevel = 0;
+	int verbosity = 0;
+
+	cli::Parser parser = {
+		cli::OptionalValue(cli::OptionString('c', "color", "colorize output", false, &color), "auto"),
+		cli::OptionalValue(cli::OptionInt('l', "log", "log level", false, &logLevel), "1"),
+		cli::OptionFlagCount('v', "verbose", "verbosity", &verbosity)
+	};
+
+	const char* argv[] = {
+		"testExe", "-vcalways", "-vl", "5"
+	};
+
+	REQUIRE(parser.parse(4, argv));
+	REQUIRE(strcmp(color, "always") == 0);
+	REQUIRE(logLevel == 1);
+	REQUIRE(verbosity == 2);
+	REQUIRE(parser.getRemainingArgs().size() == 1);
+}
+
+TEST_CASE("Decimal options", "") {
+	int64_t fee = 0;
+	int64_t rate = 0;
+	int64_t price = 0;
+
+	cli::Parser parser = {
+		cli::OptionDecimal('f', "fee", "fee rate", false, 5, &fee),
+		cli::OptionDecimal('r', "rate", "rate", false, 2, &rate),
+		cli::OptionDecimal('p', "price", "price", false, 0, &price)
+	};
+	parser.printOptionsUsage();
+
+	const char* argv[] = {
+		"testExe", "--fee=0.00125", "-r", "-3.5", "--price", "12.000"
+	};
+
+	REQUIRE(parser.parse(6, argv));
+	REQUIRE(fee == 125);
+	REQUIRE(rate == -350);
+	REQUIRE(price == 12);
+}
+
+TEST_CASE("Decimal option errors", "") {
+	const char* invalid[] = { "1.2.3", "", "-", "1e5", "0.001", "92233720368547758.08", "abc" };
+	for(const char* value : invalid) {
+		int64_t rate = 0;
+		cli::Parser parser = {
+			cli::OptionDecimal('r', "rate", "rate", false, 2, &rate)
+		};
+		const char* argv[] = { "testExe", "-r", value };
+		REQUIRE(!parser.parse(3, argv));
+	}
+
+	int64_t rate = 0;
+	cli::Parser parser = {
+		cli::OptionDecimal('r', "rate", "rate", false, 2, &rate)
+	};
+	const char* argv[] = { "testExe", "-r", "-92233720368547758.08" };
+	REQUIRE(parser.parse(3, argv));
+	REQUIRE(rate == INT64_MIN);
+
+	// a precision that can't be represented is reported as a spec error
+	cli::Parser badSpec = {
+		cli::OptionDecimal('r', "rate", "rate", false, 19, &rate)
+	};
+	const char* validArgv[] = { "testExe", "-r", "0.5" };
+	std::string errors = capturedStderr([&] {
+		REQUIRE(!badSpec.parse(3, validArgv));
+	});
+	REQUIRE(errors == "error: option -r/--rate is declared with 19 fractional digits, 0 to 18 are supported\n");
+}
+
+static std::string encodeBase64(const std::vector<unsigned char>& bytes) {
+	static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+	std::string out;
+	for(size_t i = 0; i < bytes.size(); i += 3) {
+		uint32_t bits = bytes[i] << 16;
+		if(i + 1 < bytes.size()) bits |= bytes[i+1] << 8;
+		if(i + 2 < bytes.size()) bits |= bytes[i+2];
+		out += alphabet[(bits >> 18) & 63];
+		out += alphabet[(bits >> 12) & 63];
+		out += i + 1 < bytes.size() ? alphabet[(bits >> 6) & 63] : '=';
+		out += i + 2 < bytes.size() ? alphabet[bits & 63] : '=';
+	}
+	return out;
+}
+
+TEST_CASE("Blob options", "") {
+	cli::Blob key = {};
+	unsigned char payloadBuffer[16];
+	cli::Blob payload = { payloadBuffer, sizeof(payloadBuffer) };
+
+	cli::Parser parser = {
+		cli::OptionHex('k', "key", "key", false, &key),
+		cli::OptionBase64('p', "payload", "payload", false, &payload)
+	};
+	parser.printOptionsUsage();
+
+	const char* argv[] = {
+		"testExe", "--key=00fFa5", "-p", "aGVsbG8="
+	};
+
+	REQUIRE(parser.parse(4, argv));
+	REQUIRE(key.length == 3);
+	REQUIRE(key.data[0] == 0x00);
+	REQUIRE(key.data[1] == 0xff);
+	REQUIRE(key.data[2] == 0xa5);
+	REQUIRE(payload.data == payloadBuffer);
+	REQUIRE(payload.length == 5);
+	REQUIRE(memcmp(payload.data, "hello", 5) == 0);
+}
+
+TEST_CASE("Blob decoding", "") {
+	std::vector<unsigned char> bytes(1000);
+	uint32_t seed = 12345;
+	for(unsigned char& b : bytes) {
+		seed = seed * 1103515245 + 12345;
+		b = (unsigned char)(seed >> 16);
+	}
+	std::string hex;
+	for(unsigned char b : bytes) {
+		hex += "0123456789abcdef"[b >> 4];
+		hex += "0123456789ABCDEF"[b & 15];
+	}
+	for(size_t length : { (size_t)0, (size_t)1, (size_t)2, (size_t)11, (size_t)12, (size_t)13, (size_t)47, (size_t)100, (size_t)1000 }) {
+		std::vector<unsigned char> input(bytes.begin(), bytes.begin() + length);
+		std::vector<unsigned char> out(length + 1);
+		size_t errorOffset = 0;
+
+		REQUIRE(cli::decodedHexLength(hex.data(), length*2) == length);
+		REQUIRE(cli::decodeHex(hex.data(), length*2, out.data(), errorOffset));
+		REQUIRE(memcmp(out.data(), input.data(), length) == 0);
+
+		std::string base64 = encodeBase64(input);
+		REQUIRE(cli::decodedBase64Length(base64.data(), base64.size()) == length);
+		REQUIRE(cli::decodeBase64(base64.data(), base64.size(), out.data(), errorOffset));
+		REQUIRE(memcmp(out.data(), input.data(), length) == 0);
+	}
+
+	std::string badHex = hex.substr(0, 200);
+	badHex[77] = 'g';
+	std::vector<unsigned char> out(100);
+	size_t errorOffset = 0;
+	REQUIRE(!cli::decodeHex(badHex.data(), badHex.size(), out.data(), errorOffset));
+	REQUIRE(errorOffset == 77);
+	REQUIRE(!cli::decodeHex(hex.data(), 7, out.data(), errorOffset));
+	REQUIRE(errorOffset == 7);
+
+	std::string badBase64 = encodeBase64(std::vector<unsigned char>(bytes.begin(), bytes.begin() + 90));
+	badBase64[61] = '-';
+	REQUIRE(!cli::decodeBase64(badBase64.data(), badBase64.size(), out.data(), errorOffset));
+	REQUIRE(errorOffset == 61);
+	badBase64[61] = '=';
+	REQUIRE(!cli::decodeBase64(badBase64.data(), badBase64.size(), out.data(), errorOffset));
+	REQUIRE(errorOffset == 61);
+}
+
+TEST_CASE("Blob option errors", "") {
+	unsigned char buffer[2];
+	cli::Blob small = { buffer, sizeof(buffer) };
+	cli::Blob key = {};
+
+	cli::Parser parser = {
+		cli::OptionHex('k', "key", "key", false, &small)
+	};
+	const char* argv[] = { "testExe", "-k", "001122" };
+	REQUIRE(!parser.parse(3, argv));
+
+	cli::Parser invalidParser = {
+		cli::OptionHex('k', "key", "key", false, &key)
+	};
+	const char* invalidArgv[] = { "testExe", "-k", "00x1" };
+	REQUIRE(!invalidParser.parse(3, invalidArgv));
+}
+
+TEST_CASE("Values from files", "") {
+	const char* policyPath = "cli_test_policy.json";
+	FILE* f = fopen(policyPath, "wb");
+	REQUIRE(f != NULL);
+	std::string policy(4096, 'x');
+	policy[0] = '{';
+	policy[4095] = '}';
+	fwrite(policy.data(), 1, policy.size(), f);
+	fclose(f);
+
+	const char* policyOption = NULL;
+	const char* mention = NULL;
+	const char* plain = NULL;
+	cli::Blob weights = {};
+
+	{
+		cli::Parser parser = {
+			cli::ValueFromFile(cli::OptionString('p', "policy", "policy", false, &policyOption)),
+			cli::ValueFromFile(cli::OptionString('m', "mention", "mention", false, &mention)),
+			cli::ValueFromFile(cli::OptionHex('w', "weights", "weights", false, &weights)),
+			cli::OptionString('s', "plain", "plain string", false, &plain)
+		};
+
+		std::string weightsArg = std::string("--weights=@") + policyPath;
+		const char* argv[] = {
+			"testExe", "--policy", "@cli_test_policy.json", "-m", "@@bob", weightsArg.c_str(), "-s", "@literal"
+		};
+
+		REQUIRE(parser.parse(8, argv));
+		REQUIRE(strlen(policyOption) == 4096);
+		REQUIRE(policy == policyOption);
+		REQUIRE(strcmp(mention, "@bob") == 0);
+		REQUIRE(strcmp(plain, "@literal") == 0);
+		REQUIRE(weights.length == 4096);
+		REQUIRE(memcmp(weights.data, policy.data(), 4096) == 0);
+
+		// copies share the mappings the values point into
+		std::unique_ptr<cli::Parser> original(new cli::Parser(parser));
+		original->reset();
+		REQUIRE(original->parse(8, argv));
+		cli::Parser copy(*original);
+		original.reset();
+		REQUIRE(policy == policyOption);
+		copy.reset();
+		REQUIRE(copy.parse(8, argv));
+		REQUIRE(strcmp(mention, "@bob") == 0);
+
+		cli::Parser missingParser = {
+			cli::ValueFromFile(cli::OptionString('p', "policy", "policy", false, &policyOption))
+		};
+		const char* missingArgv[] = { "testExe", "-p", "@does_not_exist.json" };
+		REQUIRE(!missingParser.parse(3, missingArgv));
+	}
+	remove(policyPath);
+}
+
+TEST_CASE("Secrets from file descriptors", "") {
+	int fds[2];
+	REQUIRE(pipe(fds) == 0);
+	REQUIRE(write(fds[1], "s3cret\n", 7) == 7);
+	char fdArg[32];
+	snprintf(fdArg, sizeof(fdArg), "--token-fd=%d", fds[0]);
+
+	cli::Secret token = {};
+	{
+		cli::Parser parser = {
+			cli::OptionSecretFd('t', "token-fd", "token", true, &token)
+		};
+		const char* argv[] = { "testExe", fdArg };
+		REQUIRE(parser.parse(2, argv));
+		REQUIRE(token.length == 6);
+		REQUIRE(strcmp(token.data, "s3cret") == 0);
+	}
+
+	REQUIRE(write(fds[1], "0123456789", 10) == 10);
+	cli::Secret small = { 8 };
+	cli::Parser longParser = {
+		cli::OptionSecretFd('t', "token-fd", "token", true, &small)
+	};
+	const char* longArgv[] = { "testExe", fdArg };
+	REQUIRE(!longParser.parse(2, longArgv));
+
+	cli::Parser invalidParser = {
+		cli::OptionSecretFd('t', "token-fd", "token", true, &small)
+	};
+	const char* invalidArgv[] = { "testExe", "--token-fd=stdin" };
+	REQUIRE(!invalidParser.parse(2, invalidArgv));
+
+	close(fds[0]);
+	close(fds[1]);
+}
+
+TEST_CASE("Glob patterns", "") {
+	cli::Pattern include;
+	cli::Pattern exclude;
+
+	cli::Parser parser = {
+		cli::OptionGlob('i', "include", "files to include", false, &include),
+		cli::OptionRegex('x', "exclude-re", "files to exclude", false, &exclude)
+	};
+	parser.printOptionsUsage();
+
+	const char* argv[] = {
+		"testExe", "--include=src/*.{cc,h}", "--exclude-re", "_(test|bench)\\.cc$"
+	};
+
+	REQUIRE(parser.parse(4, argv));
+	REQUIRE(include.match("src/main.cc"));
+	REQUIRE(include.match("src/sub/parser.h"));
+	REQUIRE(!include.match("src/main.cpp"));
+	REQUIRE(!include.match("include/main.h"));
+	REQUIRE(exclude.match("src/parser_test.cc"));
+	REQUIRE(exclude.match("parser_bench.cc"));
+	REQUIRE(!exclude.match("parser_test.cc.orig"));
+	REQUIRE(!exclude.match("parser.cc"));
+
+	const char* error = nullptr;
+	size_t errorOffset = 0;
+	cli::Pattern glob;
+	REQUIRE(glob.compile("file?[0-9][!a-c]\\*", 18, cli::Pattern::Syntax::Glob, error, errorOffset));
+	REQUIRE(glob.match("file15d*"));
+	REQUIRE(!glob.match("file15b*"));
+	REQUIRE(!glob.match("file15dx"));
+	REQUIRE(glob.compile("", 0, cli::Pattern::Syntax::Glob, error, errorOffset));
+	REQUIRE(glob.match(""));
+	REQUIRE(!glob.match("a"));
+
+	// every character is a position of the automaton
+	const char* longGlob = "third_party/chromium/src/components/autofill/core/browser/*/test_*.{cc,h}";
+	REQUIRE(glob.compile(longGlob, strlen(longGlob), cli::Pattern::Syntax::Glob, error, errorOffset));
+	REQUIRE(glob.match("third_party/chromium/src/components/autofill/core/browser/data_model/test_address.cc"));
+	REQUIRE(!glob.match("third_party/chromium/src/components/autofill/core/browser/data_model/address.cc"));
+	std::string tooLong(1024, 'a');
+	REQUIRE(!glob.compile(tooLong.c_str(), tooLong.size(), cli::Pattern::Syntax::Glob, error, errorOffset));
+	REQUIRE(strcmp(error, "pattern too long") == 0);
+	tooLong.pop_back();
+	REQUIRE(glob.compile(tooLong.c_str(), tooLong.size(), cli::Pattern::Syntax::Glob, error, errorOffset));
+	REQUIRE(glob.match(tooLong.c_str()));
+}
+
+TEST_CASE("Regex patterns", "") {
+	const char* error = nullptr;
+	size_t errorOffset = 0;
+	cli::Pattern regex;
+
+	REQUIRE(regex.compile("^v\\d+(\\.\\d+)?$", 14, cli::Pattern::Syntax::Regex, error, errorOffset));
+	REQUIRE(regex.match("v1"));
+	REQUIRE(regex.match("v12.03"));
+	REQUIRE(!regex.match("v1."));
+	REQUIRE(!regex.match("xv1"));
+
+	REQUIRE(regex.compile("a[^b]*c", 7, cli::Pattern::Syntax::Regex, error, errorOffset));
+	REQUIRE(regex.match("xxaddddcxx"));
+	REQUIRE(regex.match("ac"));
+	REQUIRE(!regex.match("abc"));
+
+	// anchors apply to their own alternative
+	REQUIRE(regex.compile("^a|b$", 5, cli::Pattern::Syntax::Regex, error, errorOffset));
+	REQUIRE(regex.match("ax"));
+	REQUIRE(regex.match("xb"));
+	REQUIRE(!regex.match("xa"));
+	REQUIRE(!regex.match("bx"));
+	REQUIRE(regex.compile("^(ab|c)$|d", 10, cli::Pattern::Syntax::Regex, error, errorOffset));
+	REQUIRE(regex.match("ab"));
+	REQUIRE(!regex.match("abc"));
+	REQUIRE(regex.match("xdx"));
+	REQUIRE(regex.compile("a\\$", 3, cli::Pattern::Syntax::Regex, error, errorOffset));
+	REQUIRE(regex.match("xa$x"));
+	REQUIRE(!regex.match("a"));
+
+	const char* invalid[] = { "(ab", "ab)", "*a", "a{2}", "[ab", "a^b", "\\", "a$b", "(^a)", "(a$)" };
+	for(const char* pattern : invalid) {
+		REQUIRE(!regex.compile(pattern, strlen(pattern), cli::Pattern::Syntax::Regex, error, errorOffset));
+		REQUIRE(!regex.match(""));
+	}
+	REQUIRE(!regex.compile("(ab", 3, cli::Pattern::Syntax::Regex, error, errorOffset));
+	REQUIRE(errorOffset == 0);
+	REQUIRE(strcmp(error, "unbalanced (") == 0);
+
+	cli::Pattern glob;
+	cli::Parser parser = {
+		cli::OptionGlob('i', "include", "files to include", false, &glob)
+	};
+	const char* argv[] = { "testExe", "-i", "*.{cc" };
+	REQUIRE(!parser.parse(3, argv));
+}
+
+TEST_CASE("Typed positional arguments", "") {
+	int64_t id = 0;
+	double scale = 0;
+	const char* output = NULL;
+	std::vector<int64_t> ids;
+	bool debug = false;
+
+	cli::Parser parser = {
+		cli::OptionFlag('D', "debug", "some flag", &debug),
+		cli::PositionalInt64("id", "first id", true, &id),
+		cli::PositionalDouble("scale", "scale", true, &scale),
+		cli::PositionalPath("output", "output file", false, &output),
+		cli::RemainingInt64("ids", "more ids", false, &ids)
+	};
+	parser.printOptionsUsage();
+
+	const char* argv[] = {
+		"testExe", "-9000000000", "-D", "2.5", "out.txt", "1", "2", "-3"
+	};
+
+	// -3 is an unknown option, use a separate list
+	REQUIRE(!parser.parse(8, argv));
+
+	cli::Parser positionalParser = {
+		cli::OptionFlag('D', "debug", "some flag", &debug),
+		cli::PositionalInt64("id", "first id", true, &id),
+		cli::PositionalDouble("scale", "scale", true, &scale),
+		cli::PositionalPath("output", "output file", false, &output),
+		cli::RemainingInt64("ids", "more ids", false, &ids)
+	};
+	const char* positionalArgv[] = {
+		"testExe", "9000000000", "-D", "2.5", "out.txt", "1", "2", "3"
+	};
+	REQUIRE(positionalParser.parse(8, positionalArgv));
+	REQUIRE(id == 9000000000LL);
+	REQUIRE(scale == 2.5);
+	REQUIRE(strcmp(output, "out.txt") == 0);
+	REQUIRE(ids.size() == 3);
+	REQUIRE(ids[2] == 3);
+	REQUIRE(positionalParser.getRemainingArgs().empty());
+
+	cli::Parser missingParser = {
+		cli::PositionalInt64("id", "first id", true, &id),
+		cli::PositionalDouble("scale", "scale", true, &scale)
+	};
+	const char* missingArgv[] = { "testExe", "12" };
+	REQUIRE(!missingParser.parse(2, missingArgv));
+}
+
+TEST_CASE("Large typed argument lists", "") {
+	const size_t count = 100000;
+	std::vector<std::string> values(count);
+	std::vector<const char*> argv(count + 2);
+	argv[0] = "testExe";
+	argv[1] = "-p";
+	for(size_t i = 0; i < count; ++i) {
+		values[i] = std::to_string(i * 3) + "." + std::to_string(i % 10);
+		argv[i + 2] = values[i].c_str();
+	}
+
+	std::vector<double> doubles;
+	std::vector<const char*> paths;
+	const char* prefix = NULL;
+	{
+		cli::Parser parser = {
+			cli::OptionString('p', "prefix", "prefix", false, &prefix),
+			cli::RemainingDouble("values", "values", true, &doubles)
+		};
+		const char* noValues[] = { "testExe", "-p", "x" };
+		REQUIRE(!parser.parse(3, noValues));
+	}
+
+	cli::Parser parser = {
+		cli::OptionString('p', "prefix", "prefix", false, &prefix),
+		cli::RemainingDouble("values", "values", true, &doubles)
+	};
+	REQUIRE(parser.parse((int)argv.size(), argv.data()));
+	REQUIRE(strcmp(prefix, values[0].c_str()) == 0);
+	REQUIRE(doubles.size() == count - 1);
+	for(size_t i = 1; i < count; ++i) {
+		REQUIRE(doubles[i - 1] == atof(values[i].c_str()));
+	}
+
+	values[77777] = "12x";
+	values[90000] = "";
+	argv[77779] = values[77777].c_str();
+	argv[90002] = values[90000].c_str();
+	cli::Parser invalidParser = {
+		cli::OptionString('p', "prefix", "prefix", false, &prefix),
+		cli::RemainingDouble("values", "values", true, &doubles)
+	};
+	REQUIRE(!invalidParser.parse((int)argv.size(), argv.data()));
+
+	cli::Parser pathParser = {
+		cli::RemainingPaths("files", "files", false, &paths)
+	};
+	REQUIRE(pathParser.parse((int)argv.size() - 2, argv.data() + 2));
+	REQUIRE(paths.size() == count - 1);
+	REQUIRE(paths.back() == argv.back());
+}
+
+TEST_CASE("Floating point syntax", "") {
+	double ratio = 0;
+	float scale = 0;
+	std::vector<double> values;
+	cli::Parser parser = {
+		cli::OptionDouble('r', "ratio", "ratio", false, &ratio),
+		cli::OptionFloat('s', "scale", "scale", false, &scale),
+		cli::RemainingDouble("values", "values", false, &values)
+	};
+	const char* argv[] = { "testExe", "--ratio=-.5", "-s", "2.5E-1", "1e5", "+3.", "1.5e+2" };
+	REQUIRE(parser.parse(7, argv));
+	REQUIRE(ratio == -0.5);
+	REQUIRE(scale == 0.25f);
+	REQUIRE(values.size() == 3);
+	REQUIRE(values[0] == 1e5);
+	REQUIRE(values[1] == 3);
+	REQUIRE(values[2] == 150);
+
+	const char* invalid[] = { ".", "+", "-", "e5", "1e", "1.2.3", "1e5e5", "--1", "0x10", "inf", "nan", " 1", "" };
+	for(const char* value : invalid) {
+		parser.reset();
+		const char* doubleArgv[] = { "testExe", "--ratio", value };
+		REQUIRE(!parser.parse(3, doubleArgv));
+		parser.reset();
+		const char* floatArgv[] = { "testExe", "-s", value };
+		REQUIRE(!parser.parse(3, floatArgv));
+		parser.reset();
+		const char* listArgv[] = { "testExe", "1", value };
+		REQUIRE(!parser.parse(3, listArgv));
+	}
+}
+
+TEST_CASE("Parameter sweeps", "") {
+	int seed = 0;
+	float lr = 0;
+	int64_t fee = 0;
+	const char* model = NULL;
+	const char* name = NULL;
+	int epochs = 0;
+
+	cli::Parser parser = {
+		cli::OptionInt('s', "seed", "seed", false, &seed),
+		cli::OptionFloat('l', "lr", "learning rate", false, &lr),
+		cli::OptionDecimal('f', "fee", "fee", false, 3, &fee),
+		cli::OptionString('m', "model", "model", false, &model),
+		cli::OptionString('n', "name", "run name", false, &name),
+		cli::OptionInt('e', "epochs", "epochs", false, &epochs)
+	};
+
+	const char* argv[] = {
+		"testExe", "--seed={1..1000}", "--lr=0.5,0.25", "-f", "{0.001,0.002,0.004}", "--model={small,large}", "--name={10..0..-5}", "-e", "7", "file"
+	};
+
+	cli::Sweep sweep;
+	REQUIRE(parser.parseSweep(10, argv, sweep));
+	REQUIRE(sweep.sweptOptionCount() == 5);
+	REQUIRE(sweep.size() == 1000 * 2 * 3 * 2 * 3);
+	REQUIRE(epochs == 7);
+	REQUIRE(seed == 1);
+	REQUIRE(lr == 0.5f);
+	REQUIRE(strcmp(model, "small") == 0);
+	REQUIRE(strcmp(name, "10") == 0);
+	REQUIRE(parser.getRemainingArgs().size() == 1);
+
+	// variant index = (((seed * 2 + lr) * 3 + fee) * 2 + model) * 3 + name
+	size_t variant = (((999 * 2 + 1) * 3 + 2) * 2 + 1) * 3 + 2;
+	REQUIRE(sweep.select(variant));
+	REQUIRE(seed == 1000);
+	REQUIRE(lr == 0.25f);
+	REQUIRE(fee == 4);
+	REQUIRE(strcmp(model, "large") == 0);
+	REQUIRE(strcmp(name, "0") == 0);
+	REQUIRE(epochs == 7);
+	REQUIRE(!sweep.select(sweep.size()));
+
+	size_t visited = 0;
+	for(size_t v : sweep) {
+		REQUIRE(v == visited);
+		REQUIRE(seed == (int)(v / 36) + 1);
+		++visited;
+	}
+	REQUIRE(visited == sweep.size());
+}
+
+TEST_CASE("Invalid parameter sweeps", "") {
+	const char* invalid[] = { "{1..}", "{1..5..0}", "{5..1}", "{5..4..2}", "{1..5000000000}", "{-5000000000..0}", "{a..b}", "{1,x}", "1,2,,3" };
+	for(const char* value : invalid) {
+		int seed = 0;
+		cli::Parser parser = {
+			cli::OptionInt('s', "seed", "seed", false, &seed)
+		};
+		const char* argv[] = { "testExe", "-s", value };
+		cli::Sweep sweep;
+		REQUIRE(!parser.parseSweep(3, argv, sweep));
+	}
+
+	// ranges and products of ranges whose size doesn't fit
+	int64_t first = 0;
+	int64_t second = 0;
+	cli::Parser wideParser = {
+		cli::OptionInt64('f', "first", "first", false, &first),
+		cli::OptionInt64('s', "second", "second", false, &second)
+	};
+	const char* fullRange[] = { "testExe", "-f", "{-9223372036854775808..9223372036854775807}" };
+	cli::Sweep wideSweep;
+	REQUIRE(!wideParser.parseSweep(3, fullRange, wideSweep));
+	const char* tooMany[] = { "testExe", "-f", "{0..4000000000}", "-s", "{0..8000000000}" };
+	wideParser.reset();
+	REQUIRE(!wideParser.parseSweep(5, tooMany, wideSweep));
+	// a single value, whatever the step
+	const char* single[] = { "testExe", "-f", "{5..5..-2}" };
+	wideParser.reset();
+	REQUIRE(wideParser.parseSweep(3, single, wideSweep));
+	REQUIRE(wideSweep.size() == 1);
+	REQUIRE(first == 5);
+
+	const char* text = NULL;
+	cli::Parser parser = {
+		cli::OptionString('t', "text", "text", false, &text)
+	};
+	const char* argv[] = { "testExe", "-t", "a,b" };
+	cli::Sweep sweep;
+	REQUIRE(parser.parseSweep(3, argv, sweep));
+	REQUIRE(sweep.size() == 1);
+	REQUIRE(strcmp(text, "a,b") == 0);
+}
+
+TEST_CASE("Unknown option pass-through", "") {
+	int verbosity = 0;
+	const char* output = NULL;
+
+	cli::Parser parser = {
+		cli::OptionFlagCount('v', "verbose", "verbosity", &verbosity),
+		cli::OptionString('o', "wrapper-output", "output", false, &output)
+	};
+	parser.passThroughUnknownOptions();
+
+	const char* argv[] = {
+		"wrapper", "-O2", "--std=c++11", "-v", "main.cc", "-Wall", "--wrapper-output", "log.txt", "-Iinclude", "-vv"
+	};
+
+	REQUIRE(parser.parse(10, argv));
+	REQUIRE(verbosity == 3);
+	REQUIRE(strcmp(output, "log.txt") == 0);
+	auto& ranges = parser.getPassThroughRanges();
+	REQUIRE(ranges.size() == 3);
+	REQUIRE(ranges[0].begin == 1);
+	REQUIRE(ranges[0].end == 3);
+	REQUIRE(ranges[1].begin == 5);
+	REQUIRE(ranges[1].end == 6);
+	REQUIRE(ranges[2].begin == 8);
+	REQUIRE(ranges[2].end == 9);
+
+	const char* const* forwarded = parser.getPassThroughArgv("c++");
+	REQUIRE(strcmp(forwarded[0], "c++") == 0);
+	REQUIRE(forwarded[1] == argv[1]);
+	REQUIRE(forwarded[2] == argv[2]);
+	REQUIRE(forwarded[3] == argv[5]);
+	REQUIRE(forwarded[4] == argv[8]);
+	REQUIRE(forwarded[5] == nullptr);
+	REQUIRE(parser.getRemainingArgs().size() == 1);
+
+	cli::Parser positionalParser = {
+		cli::OptionFlagCount('v', "verbose", "verbosity", &verbosity)
+	};
+	positionalParser.passThroughUnknownOptions(true);
+	const char* positionalArgv[] = { "wrapper", "a.o", "-lm", "-v", "b.o" };
+	REQUIRE(positionalParser.parse(5, positionalArgv));
+	forwarded = positionalParser.getPassThroughArgv("ld");
+	REQUIRE(forwarded[1] == positionalArgv[1]);
+	REQUIRE(forwarded[2] == positionalArgv[2]);
+	REQUIRE(forwarded[3] == positionalArgv[4]);
+	REQUIRE(forwarded[4] == nullptr);
+	REQUIRE(positionalParser.getPassThroughRanges().size() == 2);
+
+	// a second parse forwards only its own arguments
+	const char* secondArgv[] = { "wrapper", "c.o", "-lz" };
+	REQUIRE(positionalParser.parse(3, secondArgv));
+	forwarded = positionalParser.getPassThroughArgv("ld");
+	REQUIRE(forwarded[1] == secondArgv[1]);
+	REQUIRE(forwarded[2] == secondArgv[2]);
+	REQUIRE(forwarded[3] == nullptr);
+	REQUIRE(positionalParser.getPassThroughRanges().size() == 1);
+
+	// the argv stays terminated after a failed parse
+	const char* invalidArgv[] = { "wrapper", "d.o", "--verbose=2" };
+	REQUIRE(!positionalParser.parse(3, invalidArgv));
+	forwarded = positionalParser.getPassThroughArgv("ld");
+	REQUIRE(forwarded[1] == invalidArgv[1]);
+	REQUIRE(forwarded[2] == nullptr);
+
+	cli::Parser strictParser = {
+		cli::OptionFlagCount('v', "verbose", "verbosity", &verbosity)
+	};
+	REQUIRE(!strictParser.parse(5, positionalArgv));
+}
+
+TEST_CASE("Composite parsers", "") {
+	int logLevel = 0;
+	const char* logFile = NULL;
+	int port = 0;
+	bool debug = false;
+	std::vector<const char*> files;
+
+	cli::Parser logging = {
+		cli::OptionInt('l', "log-level", "log level", false, &logLevel),
+		cli::OptionString('L', "log-file", "log file", true, &logFile)
+	};
+	cli::Parser rpc = {
+		cli::OptionInt('p', "port", "port", false, &port)
+	};
+	cli::Parser app = {
+		cli::OptionFlag('D', "debug", "debug", &debug),
+		cli::RemainingPaths("files", "input files", false, &files)
+	};
+
+	cli::CompositeParser parser = { &logging, &rpc, &app };
+	REQUIRE(!parser.hasConflicts());
+
+	const char* argv[] = {
+		"testExe", "--port=8080", "in1", "-Dl", "3", "--log-file", "out.log", "in2"
+	};
+	REQUIRE(parser.parse(8, argv));
+	REQUIRE(port == 8080);
+	REQUIRE(logLevel == 3);
+	REQUIRE(strcmp(logFile, "out.log") == 0);
+	REQUIRE(debug);
+	REQUIRE(files.size() == 2);
+	REQUIRE(strcmp(files[1], "in2") == 0);
+
+	const char* unknownArgv[] = { "testExe", "--unknown" };
+	cli::CompositeParser unknownParser = { &rpc };
+	REQUIRE(!unknownParser.parse(2, unknownArgv));
+
+	int otherPort = 0;
+	cli::Parser other = {
+		cli::OptionInt('P', "port", "port", false, &otherPort)
+	};
+	cli::CompositeParser conflicting = { &logging, &rpc, &other };
+	REQUIRE(conflicting.hasConflicts());
+	const char* emptyArgv[] = { "testExe" };
+	REQUIRE(!conflicting.parse(1, emptyArgv));
+
+	cli::Parser shortConflict = {
+		cli::OptionFlag('p', "print", "print", &debug)
+	};
+	cli::CompositeParser shortConflicting = { &rpc, &shortConflict };
+	REQUIRE(shortConflicting.hasConflicts());
+}
+
+TEST_CASE("Repeated option policies", "") {
+	int level = 0;
+	cli::Blob key = {};
+	const char* first = NULL;
+	const char* tag = NULL;
+	bool debug = false;
+
+	cli::Parser parser = {
+		cli::OptionInt('l', "level", "level", false, &level),
+		cli::OptionHex('k', "key", "key", false, &key),
+		cli::OnRepeat(cli::OptionString('f', "first", "first", false, &first), cli::RepeatPolicy::FirstWins),
+		cli::OnRepeat(cli::OptionString('t', "tag", "tag", false, &tag), cli::RepeatPolicy::Accumulate),
+		cli::OptionFlag('D', "debug", "debug", &debug)
+	};
+	parser.setRepeatPolicy(cli::RepeatPolicy::LastWins);
+
+	const char* argv[] = {
+		"testExe", "--level=1", "-k", "zz", "-f", "a", "-t", "x", "-l", "2", "--first=b", "-D", "--key=0102", "--tag=y", "-D", "-t", "z", "file"
+	};
+
+	// the invalid key is overridden, so it's never decoded
+	REQUIRE(parser.parse(18, argv));
+	REQUIRE(level == 2);
+	REQUIRE(key.length == 2);
+	REQUIRE(strcmp(first, "a") == 0);
+	REQUIRE(strcmp(tag, "z") == 0);
+	REQUIRE(debug);
+	std::vector<const char*> tags = parser.getValues("tag");
+	REQUIRE(tags.size() == 3);
+	REQUIRE(strcmp(tags[0], "x") == 0);
+	REQUIRE(strcmp(tags[1], "y") == 0);
+	REQUIRE(strcmp(tags[2], "z") == 0);
+	REQUIRE(parser.getRemainingArgs().size() == 1);
+
+	// a second parse only accumulates its own values
+	const char* secondArgv[] = { "testExe", "-t", "w" };
+	REQUIRE(parser.parse(3, secondArgv));
+	tags = parser.getValues("tag");
+	REQUIRE(tags.size() == 1);
+	REQUIRE(strcmp(tags[0], "w") == 0);
+
+	cli::Parser strictParser = {
+		cli::OptionInt('l', "level", "level", false, &level),
+		cli::OnRepeat(cli::OptionInt('n', "count", "count", false, &level), cli::RepeatPolicy::LastWins)
+	};
+	const char* lastArgv[] = { "testExe", "-n", "x", "-n", "4" };
+	REQUIRE(strictParser.parse(5, lastArgv));
+	REQUIRE(level == 4);
+	const char* repeatedArgv[] = { "testExe", "-l", "1", "-l", "2" };
+	cli::Parser errorParser = {
+		cli::OptionInt('l', "level", "level", false, &level)
+	};
+	REQUIRE(!errorParser.parse(5, repeatedArgv));
+}
+
+TEST_CASE("Memoized validation", "") {
+	int level = 3;
+	const char* name = "default";
+	bool verbose = false;
+	int64_t first = 0;
+	std::vector<const char*> files;
+
+	cli::Parser parser = {
+		cli::OptionInt('l', "level", "level", false, &level),
+		cli::OptionString('n', "name", "name", false, &name),
+		cli::OptionFlag('v', "verbose", "verbose", &verbose),
+		cli::PositionalInt64("first", "first", false, &first),
+		cli::RemainingPaths("files", "files", false, &files)
+	};
+	cli::ValidationCache cache(2);
+
+	const char* line1[] = { "testExe", "-l", "5", "--name=a", "1", "x" };
+	const char* line2[] = { "testExe", "-l", "5", "--name=a", "2", "y" };
+	const char* line3[] = { "testExe", "-v", "7" };
+	const char* line4[] = { "testExe", "-l", "bad", "3" };
+	const char* line5[] = { "testExe", "-l", "bad", "4" };
+
+	REQUIRE(parser.validate(6, line1, cache));
+	REQUIRE(level == 5);
+	REQUIRE(strcmp(name, "a") == 0);
+	REQUIRE(first == 1);
+
+	// same options, the string value points into the new line
+	REQUIRE(parser.validate(6, line2, cache));
+	REQUIRE(cache.hitCount() == 1);
+	REQUIRE(level == 5);
+	REQUIRE(name == line2[3] + 7);
+	REQUIRE(first == 2);
+	REQUIRE(files.size() == 1);
+	REQUIRE(strcmp(files[0], "y") == 0);
+	REQUIRE(!verbose);
+
+	// defaults are restored between lines
+	REQUIRE(parser.validate(3, line3, cache));
+	REQUIRE(level == 3);
+	REQUIRE(strcmp(name, "default") == 0);
+	REQUIRE(verbose);
+	REQUIRE(first == 7);
+	REQUIRE(files.empty());
+
+	// errors are cached too, evicting an entry
+	REQUIRE(!parser.validate(4, line4, cache));
+	REQUIRE(!parser.validate(4, line5, cache));
+	REQUIRE(cache.size() == 2);
+	REQUIRE(cache.hitCount() == 2);
+	REQUIRE(cache.missCount() == 3);
+
+	cli::CommandLine lines[] = { {6, line1}, {4, line5}, {3, line3}, {6, line2} };
+	bool results[4];
+	REQUIRE(parser.validateBatch(lines, 4, results, cache) == 3);
+	REQUIRE(results[0]);
+	REQUIRE(!results[1]);
+	REQUIRE(results[2]);
+	REQUIRE(results[3]);
+	REQUIRE(strcmp(name, "a") == 0);
+	REQUIRE(first == 2);
+
+	// matches an uncached parse
+	level = 3;
+	name = "default";
+	verbose = false;
+	cli::ValidationCache noCache(0);
+	REQUIRE(parser.validate(6, line2, noCache));
+	REQUIRE(level == 5);
+	REQUIRE(first == 2);
+
+	// options accumulated by the Parser-wide policy aren't cached
+	parser.setRepeatPolicy(cli::RepeatPolicy::Accumulate);
+	const char* repeated[] = { "testExe", "-n", "x", "-n", "y" };
+	REQUIRE(parser.validate(5, repeated, cache));
+	REQUIRE(parser.getValues("name").size() == 2);
+	REQUIRE(parser.validate(5, repeated, cache));
+	REQUIRE(parser.getValues("name").size() == 2);
+}
+
+TEST_CASE("Sharded file lists", "") {
+	const char* listPath = "cli_test_files.txt";
+	FILE* f = fopen(listPath, "wb");
+	REQUIRE(f != NULL);
+	const int count = 150000;
+	for(int i = 0; i < count; ++i) {
+		fprintf(f, i % 1000 == 0 ? "dir/file%d.dat\r\n\n" : "dir/file%d.dat\n", i);
+	}
+	fprintf(f, "last");
+	fclose(f);
+
+	for(int hashed = 0; hashed < 2; ++hashed) {
+		std::vector<int> seen(count + 1);
+		size_t previousEnd = 0;
+		for(int k = 1; k <= 3; ++k) {
+			cli::FileList files(hashed ? cli::FileList::Selection::Hash : cli::FileList::Selection::Range);
+			cli::Parser parser = {
+				cli::OptionFilesFrom('f', "files-from", "file list", true, &files),
+				cli::OptionShard('s', "shard", "shard of the file list", false, &files)
+			};
+			std::string shard = std::to_string(k) + "/3";
+			std::string filesFrom = std::string("--files-from=") + listPath;
+			const char* argv[] = { "testExe", "--shard", shard.c_str(), filesFrom.c_str() };
+			REQUIRE(parser.parse(4, argv));
+			REQUIRE(files.totalCount() == count + 1);
+			bool matches = true;
+			bool contiguous = true;
+			for(const cli::FileList::Line& line : files) {
+				std::string name(line.data, line.length);
+				int index = name == "last" ? count : atoi(name.c_str() + 8);
+				matches &= name == (index == count ? std::string("last") : "dir/file" + std::to_string(index) + ".dat");
+				++seen[index];
+				contiguous &= (size_t)index == previousEnd;
+				previousEnd = index + 1;
+			}
+			REQUIRE(matches);
+			if(!hashed) {
+				// contiguous runs in file order
+				REQUIRE(contiguous);
+				REQUIRE(files.size() >= (count + 1) / 3);
+				REQUIRE(files.size() <= (count + 1) / 3 + 1);
+			}
+		}
+		REQUIRE(std::count(seen.begin(), seen.end(), 1) == count + 1);
+	}
+
+	cli::FileList files;
+	cli::Parser parser = {
+		cli::OptionFilesFrom('f', "files-from", "file list", false, &files),
+		cli::OptionShard('s', "shard", "shard of the file list", false, &files)
+	};
+	const char* wholeArgv[] = { "testExe", "-f", listPath };
+	REQUIRE(parser.parse(3, wholeArgv));
+	REQUIRE(files.size() == count + 1);
+	remove(listPath);
+
+	const char* missingArgv[] = { "testExe", "-f", listPath };
+	REQUIRE(!parser.parse(3, missingArgv));
+	const char* invalidShards[] = { "0/3", "4/3", "1/0", "1", "/3", "a/3", "1/3x" };
+	for(const char* invalidShard : invalidShards) {
+		cli::FileList other;
+		cli::Parser shardParser = {
+			cli::OptionShard('s', "shard", "shard of the file list", false, &other)
+		};
+		const char* argv[] = { "testExe", "-s", invalidShard };
+		REQUIRE(!shardParser.parse(3, argv));
+	}
+}
+
+TEST_CASE("Lazy parsing", "") {
+	const int count = 20000;
+	std::vector<std::string> names;
+	names.reserve(count);
+	std::vector<int> values(count, -1);
+	std::vector<cli::Option> spec;
+	for(int i = 0; i < count; ++i) {
+		names.push_back("opt" + std::to_string(i));
+		spec.push_back(cli::OptionInt(0, names.back().c_str(), "generated option", i == 7, &values[i]));
+	}
+	bool verbose = false;
+	spec.push_back(cli::OptionFlag('v', "verbose", "verbose", &verbose));
+
+	cli::Parser parser(std::move(spec));
+	parser.setLazy(true);
+	parser.setRepeatPolicy(cli::RepeatPolicy::LastWins);
+	const char* argv[] = { "testExe", "--opt7=1", "--opt12", "bad", "-v", "--opt19999", "5", "--opt7=2", "file" };
+	REQUIRE(parser.parse(9, argv));
+
+	// nothing is converted until it's read
+	REQUIRE(verbose);
+	REQUIRE(values[7] == -1);
+	REQUIRE(values[19999] == -1);
+	REQUIRE(*parser.get<int>("opt7") == 2);
+	REQUIRE(values[7] == 2);
+	REQUIRE(parser.get<int>("opt19999") == &values[19999]);
+	REQUIRE(values[19999] == 5);
+	REQUIRE(parser.get<int>("opt12") == NULL);
+	REQUIRE(parser.get<int>("opt12") == NULL);
+	REQUIRE(*parser.get<int>("opt100") == -1);
+	REQUIRE(parser.get<int>("missing") == NULL);
+	REQUIRE(parser.getRemainingArgs().size() == 1);
+
+	parser.reset();
+	const char* missingArgv[] = { "testExe", "--opt1=1" };
+	REQUIRE(!parser.parse(2, missingArgv));
+
+	// values read from files are read by parse(), before the file changes
+	const char* configPath = "cli_lazy_config.txt";
+	FILE* f = fopen(configPath, "wb");
+	REQUIRE(f != NULL);
+	fputs("before", f);
+	fclose(f);
+	const char* config = NULL;
+	std::vector<cli::Option> fileSpec;
+	fileSpec.push_back(cli::ValueFromFile(cli::OptionString('c', "config", "config", false, &config)));
+	cli::Parser fileParser(std::move(fileSpec));
+	fileParser.setLazy(true);
+	std::string configArg = std::string("--config=@") + configPath;
+	const char* fileArgv[] = { "testExe", configArg.c_str() };
+	REQUIRE(fileParser.parse(2, fileArgv));
+	REQUIRE(config != NULL);
+	remove(configPath);
+	f = fopen(configPath, "wb");
+	REQUIRE(f != NULL);
+	fputs("after", f);
+	fclose(f);
+	REQUIRE(strcmp(*fileParser.get<const char*>("config"), "before") == 0);
+	remove(configPath);
+
+	// get() returns converted values outside of lazy mode
+	int level = 0;
+	cli::Parser eagerParser = {
+		cli::OptionInt('l', "level", "level", false, &level)
+	};
+	const char* eagerArgv[] = { "testExe", "-l", "3" };
+	REQUIRE(eagerParser.parse(3, eagerArgv));
+	REQUIRE(level == 3);
+	REQUIRE(eagerParser.get<int>("level") == &level);
+}
+
+#if defined(__linux__)
+TEST_CASE("Shared values", "") {
+	int workers = 1;
+	double ratio = 0.5;
+	const char* name = NULL;
+	const char* unset = NULL;
+	bool verbose = false;
+	cli::Blob key = {};
+	cli::Parser parser = {
+		cli::OptionInt('w', "workers", "workers", false, &workers),
+		cli::OptionDouble('r', "ratio", "ratio", false, &ratio),
+		cli::OptionString('n', "name", "name", false, &name),
+		cli::OptionString('u', "unset", "unset", false, &unset),
+		cli::OptionFlag('v', "verbose", "verbose", &verbose),
+		cli::OptionHex('k', "key", "key", false, &key)
+	};
+	const char* argv[] = { "testExe", "-w", "64", "--name=server", "-v", "-k", "c0ffee" };
+	REQUIRE(parser.parse(7, argv));
+
+	cli::SharedValues shared;
+	REQUIRE(shared.create(parser));
+	REQUIRE(shared.fd() >= 0);
+	// sealed, the contents can't change
+	REQUIRE(write(shared.fd(), "x", 1) < 0);
+
+	pid_t child = fork();
+	if(child == 0) {
+		cli::SharedValues values;
+		bool valid = values.open(shared.fd()) &&
+			*values.get<int>("workers") == 64 &&
+			strcmp(values.getString("name"), "server") == 0;
+		_exit(valid ? 0 : 1);
+	}
+	int status = 0;
+	REQUIRE(waitpid(child, &status, 0) == child);
+	REQUIRE(WIFEXITED(status));
+	REQUIRE(WEXITSTATUS(status) == 0);
+
+	cli::SharedValues values;
+	REQUIRE(values.open(shared.fd()));
+	REQUIRE(values.isSet("workers"));
+	REQUIRE(!values.isSet("ratio"));
+	REQUIRE(*values.get<double>("ratio") == 0.5);
+	REQUIRE(values.get<int>("ratio") == NULL);
+	REQUIRE(values.get<int>("name") == NULL);
+	REQUIRE(values.get<int>("missing") == NULL);
+	REQUIRE(*values.get<bool>("verbose"));
+	REQUIRE(values.getString("unset") == NULL);
+	cli::Blob sharedKey = values.getBlob("key");
+	REQUIRE(sharedKey.length == 3);
+	REQUIRE(sharedKey.data[0] == 0xc0);
+
+	cli::SharedValues moved(std::move(shared));
+	REQUIRE(shared.fd() < 0);
+	REQUIRE(moved.getString("name") != name);
+
+	int pipeFds[2];
+	REQUIRE(pipe(pipeFds) == 0);
+	REQUIRE(!values.open(pipeFds[0]));
+	close(pipeFds[0]);
+	close(pipeFds[1]);
+
+	// unsealed copies and records pointing out of the snapshot are refused
+	std::vector<unsigned char> image(moved.size());
+	REQUIRE(pread(moved.fd(), image.data(), image.size(), 0) == (ssize_t)image.size());
+	auto copy = [](const std::vector<unsigned char>& bytes, bool seal) {
+		int fd = memfd_create("cli-test", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+		if(fd >= 0 && write(fd, bytes.data(), bytes.size()) == (ssize_t)bytes.size() && seal) {
+			fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE);
+		}
+		return fd;
+	};
+	int fd = copy(image, true);
+	REQUIRE(values.open(fd));
+	close(fd);
+	fd = copy(image, false);
+	REQUIRE(!values.open(fd));
+	close(fd);
+	// the first record's name, then its value
+	const size_t recordOffset = 24;
+	for(size_t field : { 0, 4, 8, 12 }) {
+		std::vector<unsigned char> corrupt = image;
+		uint32_t huge = 0xfffffff8;
+		memcpy(&corrupt[recordOffset + field], &huge, sizeof(huge));
+		fd = copy(corrupt, true);
+		REQUIRE(!values.open(fd));
+		close(fd);
+	}
+	std::vector<unsigned char> tooManyRecords = image;
+	uint32_t count = 0xffffffff;
+	memcpy(&tooManyRecords[16], &count, sizeof(count));
+	fd = copy(tooManyRecords, true);
+	REQUIRE(!values.open(fd));
+	close(fd);
+}
+#endif
+
+TEST_CASE("Parsing string views", "") {
+	int level = 0;
+	double ratio = 0;
+	const char* name = NULL;
+	cli::StringView tag = {};
+	std::vector<int64_t> numbers;
+	cli::Parser parser = {
+		cli::OptionInt('l', "level", "level", false, &level),
+		cli::OptionDouble('r', "ratio", "ratio", false, &ratio),
+		cli::OptionString('n', "name", "name", false, &name),
+		cli::OptionStringView('t', "tag", "tag", false, &tag),
+		cli::RemainingInt64("numbers", "numbers", false, &numbers)
+	};
+
+	// arguments sliced from a request buffer, none of them NUL-terminated
+	const char buffer[] = "prog-l42--name=alpha--ratio0.25-tbeta1234567";
+	cli::StringView args[] = {
+		{buffer, 4}, {buffer+4, 2}, {buffer+6, 2}, {buffer+8, 12}, {buffer+20, 7}, {buffer+27, 4}, {buffer+31, 2}, {buffer+33, 4}, {buffer+37, 3}, {buffer+40, 4}
+	};
+	REQUIRE(parser.parse(args, 10));
+	REQUIRE(level == 42);
+	REQUIRE(strcmp(name, "alpha") == 0);
+	REQUIRE(ratio == 0.25);
+	REQUIRE(tag.data == buffer+33);
+	REQUIRE(tag.length == 4);
+	REQUIRE(numbers.size() == 2);
+	REQUIRE(numbers[0] == 123);
+	REQUIRE(numbers[1] == 4567);
+
+	std::vector<std::string> strings = { "prog", "--tag=x", "-l", "7", "9" };
+	cli::Parser vectorParser = {
+		cli::OptionInt('l', "level", "level", false, &level),
+		cli::OptionStringView('t', "tag", "tag", false, &tag),
+		cli::RemainingInt64("numbers", "numbers", false, &numbers)
+	};
+	REQUIRE(vectorParser.parse(strings.begin(), strings.end()));
+	REQUIRE(level == 7);
+	REQUIRE(tag.data == strings[1].data() + 6);
+	REQUIRE(numbers.size() == 1);
+	REQUIRE(numbers[0] == 9);
+
+	// values are bounded by their length, not by the next argument
+	const char invalidBuffer[] = "prog-l12x";
+	cli::StringView invalidArgs[] = { {invalidBuffer, 4}, {invalidBuffer+4, 2}, {invalidBuffer+6, 2} };
+	int other = 0;
+	cli::Parser invalidParser = {
+		cli::OptionInt('l', "level", "level", false, &other)
+	};
+	REQUIRE(invalidParser.parse(invalidArgs, 3));
+	REQUIRE(other == 12);
+	cli::StringView wrongArgs[] = { {invalidBuffer, 4}, {invalidBuffer+4, 2}, {invalidBuffer+6, 3} };
+	REQUIRE(!invalidParser.parse(wrongArgs, 3));
+
+	const char* remainingBuffer = "progfile";
+	cli::StringView remainingArgs[] = { {remainingBuffer, 4}, {remainingBuffer+4, 3} };
+	cli::Parser remainingParser = {
+		cli::OptionInt('l', "level", "level", false, &other)
+	};
+	REQUIRE(remainingParser.parse(remainingArgs, 2));
+	REQUIRE(strcmp(remainingParser.getRemainingArgs()[0], "fil") == 0);
+}
+
+TEST_CASE("Encoded arguments", "") {
+	std::string longValue(300, 'v');
+	const char* argv[] = { "prog", "--tag", longValue.c_str(), "-l", "5", "" };
+	size_t length = cli::encodedArgumentsLength(6, argv);
+	REQUIRE(length == 1 + 5 + 6 + 302 + 3 + 2 + 1);
+	std::vector<unsigned char> encoded(length);
+	REQUIRE(cli::encodeArguments(6, argv, encoded.data()) == length);
+
+	std::vector<cli::StringView> args;
+	REQUIRE(cli::decodeArguments(encoded.data(), length, args));
+	REQUIRE(args.size() == 6);
+	REQUIRE(args[2].length == 300);
+	REQUIRE(args[5].length == 0);
+
+	int level = 0;
+	cli::StringView tag = {};
+	cli::Parser parser = {
+		cli::OptionInt('l', "level", "level", false, &level),
+		cli::OptionStringView('t', "tag", "tag", false, &tag)
+	};
+	REQUIRE(parser.parseEncoded(encoded.data(), length));
+	REQUIRE(level == 5);
+	REQUIRE((const unsigned char*)tag.data == encoded.data() + 14);
+	REQUIRE(tag.length == 300);
+	REQUIRE(parser.getRemainingArgs().size() == 1);
+
+	// truncated, trailing bytes and oversized counts are rejected
+	REQUIRE(!parser.parseEncoded(encoded.data(), length - 1));
+	encoded.push_back(0);
+	REQUIRE(!cli::decodeArguments(encoded.data(), encoded.size(), args));
+	const unsigned char hugeCount[] = { 0xff, 0xff, 0xff, 0xff, 0x0f, 0x00 };
+	REQUIRE(!cli::decodeArguments(hugeCount, sizeof(hugeCount), args));
+	const unsigned char unterminatedVarint[] = { 0x01, 0x80 };
+	REQUIRE(!cli::decodeArguments(unterminatedVarint, sizeof(unterminatedVarint), args));
+
+	// an empty command line, without even a program name
+	const unsigned char empty[] = { 0x00 };
+	REQUIRE(cli::decodeArguments(empty, sizeof(empty), args));
+	REQUIRE(args.empty());
+	parser.reset();
+	REQUIRE(parser.parseEncoded(empty, sizeof(empty)));
+	REQUIRE(parser.getRemainingArgs().empty());
+	REQUIRE(parser.parse(0, nullptr));
+}
+
+TEST_CASE("Captured command lines", "") {
+	const char* logPath = "cli_capture_test.log";
+	remove(logPath);
+	int level = 0;
+	bool verbose = false;
+	const char* name = nullptr;
+	cli::Parser parser = {
+		cli::OptionInt('l', "level", "level", false, &level),
+		cli::OptionFlag('v', "verbose", "verbose", &verbose),
+		cli::OptionString('n', "name", "name", false, &name)
+	};
+	int otherLevel = 0;
+	cli::Parser otherParser = {
+		cli::OptionInt('l', "depth", "depth", false, &otherLevel)
+	};
+	REQUIRE(parser.fingerprint() != otherParser.fingerprint());
+
+	cli::setCaptureFile(logPath);
+	const char* first[] = { "/usr/bin/tool", "--name=Secret-42", "-vl7", "--token=x9", "input.txt" };
+	REQUIRE(!parser.parse(5, first));
+	parser.reset();
+	const char* second[] = { "tool", "-l", "12" };
+	REQUIRE(parser.parse(3, second));
+	const char* third[] = { "tool", "-l", "3" };
+	REQUIRE(otherParser.parse(3, third));
+	cli::setCaptureFile(nullptr);
+	parser.reset();
+	REQUIRE(parser.parse(3, second));
+
+	FILE* file = fopen(logPath, "rb");
+	REQUIRE(file != nullptr);
+	std::vector<unsigned char> log(4096);
+	log.resize(fread(log.data(), 1, log.size(), file));
+	fclose(file);
+	remove(logPath);
+
+	const unsigned char* cursor = log.data();
+	const unsigned char* end = log.data() + log.size();
+	cli::CapturedLine line;
+	std::vector<cli::StringView> args;
+	auto argument = [&](size_t i) {
+		return std::string(args[i].data, args[i].length);
+	};
+
+	REQUIRE(cli::readCapturedLine(cursor, end, line));
+	REQUIRE(line.fingerprint == parser.fingerprint());
+	REQUIRE(cli::decodeArguments(line.arguments, line.length, args));
+	REQUIRE(args.size() == 5);
+	REQUIRE(argument(0) == "tool");
+	REQUIRE(argument(1) == "--name=aaaaaa-11");
+	REQUIRE(argument(2) == "-vl1");
+	REQUIRE(argument(3) == "--aaaaa=a1");
+	REQUIRE(argument(4) == "aaaaa.aaa");
+
+	REQUIRE(cli::readCapturedLine(cursor, end, line));
+	REQUIRE(line.fingerprint == parser.fingerprint());
+	parser.reset();
+	REQUIRE(parser.parseEncoded(line.arguments, line.length));
+	REQUIRE(level == 11);
+
+	REQUIRE(cli::readCapturedLine(cursor, end, line));
+	REQUIRE(line.fingerprint == otherParser.fingerprint());
+	REQUIRE(cursor == end);
+	REQUIRE(!cli::readCapturedLine(cursor, end, line));
+
+	// truncated records are rejected
+	cursor = log.data();
+	REQUIRE(!cli::readCapturedLine(cursor, log.data() + 5, line));
+}
+
+TEST_CASE("Usage counters", "") {
+	const char* directory = "cli_usage_test";
+	mkdir(directory, 0755);
+	cli::setUsageDirectory(directory);
+
+	int level = 0;
+	bool verbose = false;
+	bool dryRun = false;
+	std::vector<const char*> files;
+	auto makeParser = [&] {
+		return std::unique_ptr<cli::Parser>(new cli::Parser {
+			cli::OptionInt('l', "level", "level", false, &level),
+			cli::OptionFlag('v', "verbose", "verbose", &verbose),
+			cli::OptionFlag('n', "dry-run", "dry run", &dryRun),
+			cli::RemainingPaths("files", "files", false, &files)
+		});
+	};
+	// two parsers with the same spec share a segment, like two processes
+	std::unique_ptr<cli::Parser> first = makeParser();
+	std::unique_ptr<cli::Parser> second = makeParser();
+	const char* argv[] = { "tool", "-v", "--level=3", "a", "b" };
+	REQUIRE(first->parse(5, argv));
+	first->reset();
+	const char* levelOnly[] = { "tool", "-l", "4" };
+	REQUIRE(first->parse(3, levelOnly));
+	REQUIRE(second->parse(5, argv));
+	cli::setUsageDirectory(nullptr);
+
+	char path[64];
+	snprintf(path, sizeof(path), "%s/%016llx.usage", directory, (unsigned long long)first->fingerprint());
+	cli::UsageSegment segment;
+	REQUIRE(segment.open(path));
+	REQUIRE(segment.fingerprint() == first->fingerprint());
+	REQUIRE(segment.parses() == 3);
+	REQUIRE(segment.optionCount() == 4);
+	REQUIRE(strcmp(segment.name(0), "level") == 0);
+	REQUIRE(strcmp(segment.name(3), "files") == 0);
+	REQUIRE(segment.name(4) == nullptr);
+	REQUIRE(segment.count(0) == 3);
+	REQUIRE(segment.count(1) == 2);
+	REQUIRE(segment.count(2) == 0);
+	REQUIRE(segment.count(3) == 2);
+
+	// parsers created once counting is disabled don't count
+	std::unique_ptr<cli::Parser> third = makeParser();
+	REQUIRE(third->parse(5, argv));
+	REQUIRE(segment.parses() == 3);
+
+	// temporary names left by a crashed process with the same pid are skipped
+	bool stale = false;
+	cli::Parser staleParser = { cli::OptionFlag('s', "stale", "stale", &stale) };
+	char segmentPath[64];
+	snprintf(segmentPath, sizeof(segmentPath), "%s/%016llx.usage", directory, (unsigned long long)staleParser.fingerprint());
+	std::vector<std::string> staleFiles;
+	for(int i = 0; i < 32; ++i) {
+		staleFiles.push_back(std::string(segmentPath) + "." + std::to_string((long)getpid()) + "." + std::to_string(i));
+		fclose(fopen(staleFiles.back().c_str(), "w"));
+	}
+	cli::setUsageDirectory(directory);
+	const char* staleArgv[] = { "tool", "-s" };
+	REQUIRE(staleParser.parse(2, staleArgv));
+	cli::setUsageDirectory(nullptr);
+	cli::UsageSegment staleSegment;
+	REQUIRE(staleSegment.open(segmentPath));
+	REQUIRE(staleSegment.count(0) == 1);
+	for(const std::string& file : staleFiles) {
+		remove(file.c_str());
+	}
+	remove(segmentPath);
+
+	REQUIRE(!segment.open("cli_usage_test/missing.usage"));
+	REQUIRE(!segment.isOpen());
+	remove(path);
+	rmdir(directory);
+}
+
+TEST_CASE("Compressed descriptions", "") {
+	const char* names[] = { "level", "verbose", "files", "unknown" };
+	const char* descriptions[] = { "compression level", "verbose logging, verbose logging", "files", "not an option" };
+	std::vector<unsigned char> table;
+	cli::encodeDescriptions(names, descriptions, 4, table);
+	std::vector<char> text;
+	REQUIRE(cli::decodeDescriptions(table.data(), table.size(), text));
+	REQUIRE(text.size() == 99);
+	REQUIRE(strcmp(&text[6], "compression level") == 0);
+
+	int level = 0;
+	bool verbose = false;
+	std::vector<const char*> files;
+	auto makeParser = [&] {
+		return std::unique_ptr<cli::Parser>(new cli::Parser {
+			cli::OptionInt('l', "level", nullptr, false, &level),
+			cli::OptionFlag('v', "verbose", "kept", &verbose),
+			cli::RemainingPaths("files", nullptr, false, &files)
+		});
+	};
+	std::unique_ptr<cli::Parser> parser = makeParser();
+	parser->setDescriptions(table.data(), table.size());
+	REQUIRE(strcmp(parser->description("level"), "compression level") == 0);
+	REQUIRE(strcmp(parser->description("verbose"), "kept") == 0);
+	REQUIRE(strcmp(parser->description("files"), "files") == 0);
+	REQUIRE(parser->description("unknown") == nullptr);
+
+	// the file is only read when a description is needed
+	const char* path = "cli_descriptions_test.bin";
+	remove(path);
+	parser = makeParser();
+	parser->setDescriptionFile(path);
+	const char* argv[] = { "tool", "-l", "3", "a" };
+	REQUIRE(parser->parse(4, argv));
+	FILE* f = fopen(path, "wb");
+	REQUIRE(f != nullptr);
+	fwrite(table.data(), 1, table.size(), f);
+	fclose(f);
+	parser->printOptionsUsage();
+	REQUIRE(strcmp(parser->description("level"), "compression level") == 0);
+	remove(path);
+
+	// runs are matches that overlap the bytes they produce
+	std::string repeated(1000, 'x');
+	const char* longDescriptions[] = { repeated.c_str() };
+	cli::encodeDescriptions(names, longDescriptions, 1, table);
+	REQUIRE(table.size() < 100);
+	REQUIRE(cli::decodeDescriptions(table.data(), table.size(), text));
+	REQUIRE(strcmp(&text[6], repeated.c_str()) == 0);
+
+	std::vector<unsigned char> corrupted = table;
+	corrupted[0] = 'X';
+	REQUIRE(!cli::decodeDescriptions(corrupted.data(), corrupted.size(), text));
+	for(size_t length = 0; length < table.size(); ++length) {
+		REQUIRE(!cli::decodeDescriptions(table.data(), length, text));
+	}
+	parser = makeParser();
+	parser->setDescriptions(table.data(), table.size() - 1);
+	REQUIRE(parser->description("level") == nullptr);
+
+	// options left without a description print an empty one
+	parser = makeParser();
+	parser->setDescriptionFile("cli_descriptions_missing.bin");
+	std::string printed = capturedStderr([&] {
+		parser->printOptionsUsage();
+	});
+	REQUIRE(printed.find("invalid option descriptions") != std::string::npos);
+	REQUIRE(printed.find("--level <integer>\t\n") != std::string::npos);
+	REQUIRE(printed.find("(null)") == std::string::npos);
+}